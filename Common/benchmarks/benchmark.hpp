@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <vector>
+
+#include "macros.hpp"
+#include "time_utils.hpp"
+#include "thread_utils.hpp"
+
+namespace Benchmarks {
+    using Common::Nanos;
+    using Common::getCurrentNanos;
+
+    /// Summary of one benchmark, latencies are nanoseconds per operation.
+    struct BenchmarkResult {
+        std::string name_;
+        size_t samples_ = 0;
+        double mean_ = 0;
+        double p50_ = 0;
+        double p90_ = 0;
+        double p99_ = 0;
+        double p999_ = 0;
+        double max_ = 0;
+        double ops_per_sec_ = 0;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss.precision(1);
+            ss << std::fixed << name_
+            << " samples:" << samples_
+            << " mean:" << mean_
+            << " p50:" << p50_
+            << " p90:" << p90_
+            << " p99:" << p99_
+            << " p99.9:" << p999_
+            << " max:" << max_;
+            if(ops_per_sec_ > 0)
+                ss << " ops/s:" << ops_per_sec_;
+
+            return ss.str();
+        }
+
+        auto toJSON() const {
+            std::stringstream ss;
+            ss.precision(3);
+            ss << std::fixed << "{\"name\": \"" << name_ << "\""
+            << ", \"unit\": \"ns\""
+            << ", \"samples\": " << samples_
+            << ", \"mean\": " << mean_
+            << ", \"p50\": " << p50_
+            << ", \"p90\": " << p90_
+            << ", \"p99\": " << p99_
+            << ", \"p99.9\": " << p999_
+            << ", \"max\": " << max_
+            << ", \"ops_per_sec\": " << ops_per_sec_
+            << "}";
+
+            return ss.str();
+        }
+    };
+
+    /// Collects per operation latencies. Operations too cheap to time one by one are timed in batches
+    /// and recorded as the per operation average of the batch.
+    class LatencyRecorder {
+        private:
+            std::vector<double> samples_;
+
+        public:
+            explicit LatencyRecorder(size_t expected_samples) {
+                samples_.reserve(expected_samples);
+            }
+
+            auto record(double nanos) noexcept {
+                samples_.push_back(nanos);
+            }
+
+            auto size() const noexcept {
+                return samples_.size();
+            }
+
+            auto summarize(const std::string& name, double ops_per_sec = 0) -> BenchmarkResult {
+                ASSERT(!samples_.empty(), "No samples recorded for " + name);
+
+                std::sort(samples_.begin(), samples_.end());
+
+                auto percentile = [this](double p){
+                    return samples_[std::min(samples_.size() - 1, static_cast<size_t>(p * samples_.size()))];
+                };
+
+                double sum = 0;
+                for(const auto sample : samples_)
+                    sum += sample;
+
+                return BenchmarkResult{name, samples_.size(), sum / samples_.size(), percentile(0.5), percentile(0.9),
+                                       percentile(0.99), percentile(0.999), samples_.back(), ops_per_sec};
+            }
+    };
+
+    struct BenchmarkConfig {
+        int main_core_ = -1;
+        int worker_core_ = -1;
+        double scale_ = 1;
+    };
+
+    class BenchmarkContext {
+        private:
+            const BenchmarkConfig config_;
+            std::vector<BenchmarkResult> results_;
+
+        public:
+            explicit BenchmarkContext(const BenchmarkConfig& config) : config_(config) {}
+
+            auto& config() const noexcept {
+                return config_;
+            }
+
+            /// Iteration count scaled by --scale.
+            auto iterations(size_t base) const noexcept {
+                return std::max<size_t>(1, static_cast<size_t>(base * config_.scale_));
+            }
+
+            auto report(const BenchmarkResult& result) {
+                std::cout << result.toString() << std::endl;
+                results_.push_back(result);
+            }
+
+            auto& results() const noexcept {
+                return results_;
+            }
+    };
+
+    typedef std::function<void(BenchmarkContext&)> BenchmarkFunc;
+
+    inline auto& benchmarkRegistry() {
+        static std::vector<std::pair<std::string, BenchmarkFunc>> registry;
+        return registry;
+    }
+
+    struct BenchmarkRegistrar {
+        BenchmarkRegistrar(const std::string& name, BenchmarkFunc func) {
+            benchmarkRegistry().emplace_back(name, func);
+        }
+    };
+
+    /// Spin on cond, backing off to yield() so that a ping-pong still completes when both threads share a core.
+    template<typename F>
+    inline auto spinUntil(F&& cond) noexcept {
+        for(size_t spins = 0; !cond(); spins++){
+            if(spins > 1024) [[unlikely]]
+                std::this_thread::yield();
+        }
+    }
+
+    /// Keeps the compiler from optimising away a benchmarked value.
+    template<typename T>
+    inline auto doNotOptimize(const T& value) noexcept {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+}
+
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+#define REGISTER_BENCHMARK(name, func) static const Benchmarks::BenchmarkRegistrar BENCHMARK_CONCAT(benchmark_registrar_, __LINE__)(name, func)
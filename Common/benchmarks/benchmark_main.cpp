@@ -0,0 +1,74 @@
+#include <fstream>
+
+#include "benchmark.hpp"
+
+using namespace Benchmarks;
+
+/// Usage: benchmarks [--filter=substr] [--json=file] [--cores=main,worker] [--scale=factor]
+int main(int argc, char** argv){
+    BenchmarkConfig config;
+    std::string filter;
+    std::string json_file;
+
+    // Pin to the first two cores by default when there are enough of them.
+    if(std::thread::hardware_concurrency() >= 2){
+        config.main_core_ = 0;
+        config.worker_core_ = 1;
+    }
+
+    for(int i = 1; i < argc; i++){
+        const std::string arg = argv[i];
+        const auto value = arg.substr(arg.find('=') + 1);
+
+        if(arg.starts_with("--filter=")){
+            filter = value;
+        } else if(arg.starts_with("--json=")){
+            json_file = value;
+        } else if(arg.starts_with("--cores=")){
+            const auto comma = value.find(',');
+            ASSERT(comma != std::string::npos, "--cores expects main,worker");
+            config.main_core_ = std::stoi(value.substr(0, comma));
+            config.worker_core_ = std::stoi(value.substr(comma + 1));
+        } else if(arg.starts_with("--scale=")){
+            config.scale_ = std::stod(value);
+        } else {
+            FATAL("Unknown argument: " + arg);
+        }
+    }
+
+    if(config.main_core_ >= 0 && !Common::setThreadCore(config.main_core_))
+        FATAL("Failed to set core affinity for benchmark main thread to " + std::to_string(config.main_core_));
+
+    BenchmarkContext context(config);
+
+    auto& registry = benchmarkRegistry();
+    std::sort(registry.begin(), registry.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+
+    for(const auto& [name, func] : registry){
+        if(!filter.empty() && name.find(filter) == std::string::npos)
+            continue;
+
+        std::cerr << "Running " << name << "..." << std::endl;
+        func(context);
+    }
+
+    if(!json_file.empty()){
+        std::string time_str;
+        std::ofstream fout(json_file);
+        ASSERT(fout.is_open(), "Could not open json file: " + json_file);
+
+        fout << "{\n  \"context\": {\"date\": \"" << Common::getCurrentTimeStr(&time_str).c_str() << "\""
+             << ", \"num_cpus\": " << std::thread::hardware_concurrency()
+             << ", \"main_core\": " << config.main_core_
+             << ", \"worker_core\": " << config.worker_core_
+             << ", \"scale\": " << config.scale_ << "},\n  \"benchmarks\": [\n";
+
+        const auto& results = context.results();
+        for(size_t i = 0; i < results.size(); i++)
+            fout << "    " << results[i].toJSON() << (i + 1 < results.size() ? ",\n" : "\n");
+
+        fout << "  ]\n}\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <tuple>
+
+#include "benchmark.hpp"
+#include "fix_encoder.hpp"
+#include "fix_parser.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t BATCH_SIZE = 64;
+    constexpr size_t NUM_MESSAGES = 4096;
+    constexpr int PRICE_DECIMALS = 4;
+
+    auto supportedLevels() {
+        std::vector<FIXSimdLevel> levels;
+        for(auto level : {FIXSimdLevel::SCALAR, FIXSimdLevel::SSE42, FIXSimdLevel::AVX2}){
+            if(level <= bestFIXSimdLevel())
+                levels.push_back(level);
+        }
+        return levels;
+    }
+
+    /// NewOrderSingle with the fields a typical client sends.
+    auto makeNewOrderSingle() {
+        auto message = new FIXMessageTemplate("FIX.4.4", "D", "CLIENT0001", "LLENGINE");
+        message->addField(1, "ACCOUNT-0001");
+        const auto cl_ord_id = message->addVariableField(FIX_TAG_CL_ORD_ID, 12);
+        message->addField(21, "1");
+        message->addField(FIX_TAG_SYMBOL, "ESZ6");
+        const auto side = message->addVariableField(FIX_TAG_SIDE, 1);
+        message->addField(60, "20261019-12:00:00.000");
+        const auto qty = message->addVariableField(FIX_TAG_ORDER_QTY, 6);
+        message->addField(40, "2");
+        const auto price = message->addVariableField(FIX_TAG_PRICE, 11);
+        message->addField(59, "0");
+        message->seal();
+
+        return std::make_tuple(message, cl_ord_id, side, qty, price);
+    }
+
+    struct OrderFields {
+        uint64_t cl_ord_id_;
+        char side_;
+        int64_t qty_;
+        int64_t price_;
+    };
+
+    auto orderFields(size_t i) {
+        return OrderFields{1000000 + i, (i % 2) ? '1' : '2', static_cast<int64_t>(i % 1000 + 1), static_cast<int64_t>(45000000 + (i % 500) * 2500)};
+    }
+
+    /// Parse a stream of NewOrderSingles back to back, as they sit in a socket buffer, and read the order fields.
+    auto fixParse(BenchmarkContext& context) {
+        const auto num_passes = context.iterations(200);
+
+        auto [order, cl_ord_id, side, qty, price] = makeNewOrderSingle();
+        std::vector<char> stream;
+        for(size_t i = 0; i < NUM_MESSAGES; i++){
+            const auto fields = orderFields(i);
+            order->setInt(cl_ord_id, fields.cl_ord_id_);
+            order->setChar(side, fields.side_);
+            order->setInt(qty, fields.qty_);
+            order->setDecimal(price, fields.price_, PRICE_DECIMALS);
+            order->finalize(i + 1, getCurrentNanos());
+            stream.insert(stream.end(), order->data(), order->data() + order->size());
+        }
+        const auto message_len = order->size();
+        delete order;
+
+        for(const auto level : supportedLevels()){
+            FIXParser parser(level);
+            FIXMessage message;
+            LatencyRecorder recorder(num_passes * NUM_MESSAGES / BATCH_SIZE);
+            size_t mismatches = 0;
+
+            const auto start = getCurrentNanos();
+            for(size_t pass = 0; pass < num_passes; pass++){
+                size_t offset = 0;
+                for(size_t batch = 0; batch < NUM_MESSAGES / BATCH_SIZE; batch++){
+                    const auto batch_start = getCurrentNanos();
+                    for(size_t i = 0; i < BATCH_SIZE; i++){
+                        size_t msg_len = 0;
+                        const auto result = parser.parse(stream.data() + offset, stream.size() - offset, &message, &msg_len);
+
+                        const auto expected = orderFields(batch * BATCH_SIZE + i);
+                        mismatches += (result != FIXParseResult::OK) |
+                                      (static_cast<uint64_t>(message.getInt(FIX_TAG_CL_ORD_ID)) != expected.cl_ord_id_) |
+                                      (message.getChar(FIX_TAG_SIDE) != expected.side_) |
+                                      (message.getInt(FIX_TAG_ORDER_QTY) != expected.qty_) |
+                                      (message.getDecimal(FIX_TAG_PRICE, PRICE_DECIMALS) != expected.price_);
+                        offset += msg_len;
+                    }
+                    recorder.record(static_cast<double>(getCurrentNanos() - batch_start) / BATCH_SIZE);
+                }
+            }
+            const auto elapsed = getCurrentNanos() - start;
+
+            ASSERT(!mismatches, "FIXParser " + fixSimdLevelToString(level) + " mismatched " + std::to_string(mismatches) + " messages.");
+
+            const auto msgs_per_sec = static_cast<double>(num_passes * NUM_MESSAGES) * NANOS_TO_SECS / elapsed;
+            context.report(recorder.summarize("fix/parse_" + std::to_string(message_len) + "B/" + fixSimdLevelToString(level), msgs_per_sec));
+        }
+    }
+
+    /// Patch an ExecutionReport template and finalize it, the per message cost of the outbound path.
+    auto fixEncode(BenchmarkContext& context) {
+        const auto num_batches = context.iterations(20000);
+
+        for(const auto level : supportedLevels()){
+            FIXMessageTemplate report("FIX.4.4", "8", "LLENGINE", "CLIENT0001", level);
+            const auto order_id = report.addVariableField(37, 12);
+            const auto cl_ord_id = report.addVariableField(FIX_TAG_CL_ORD_ID, 12);
+            const auto exec_id = report.addVariableField(17, 12);
+            report.addField(150, "F");
+            report.addField(39, "2");
+            report.addField(FIX_TAG_SYMBOL, "ESZ6");
+            const auto side = report.addVariableField(FIX_TAG_SIDE, 1);
+            const auto last_qty = report.addVariableField(32, 6);
+            const auto last_px = report.addVariableField(31, 11);
+            const auto leaves_qty = report.addVariableField(151, 6);
+            const auto cum_qty = report.addVariableField(14, 6);
+            report.seal();
+
+            LatencyRecorder recorder(num_batches);
+            uint64_t seq_num = 1;
+
+            const auto start = getCurrentNanos();
+            for(size_t batch = 0; batch < num_batches; batch++){
+                const auto batch_start = getCurrentNanos();
+                for(size_t i = 0; i < BATCH_SIZE; i++, seq_num++){
+                    const auto fields = orderFields(seq_num);
+                    report.setInt(order_id, seq_num);
+                    report.setInt(cl_ord_id, fields.cl_ord_id_);
+                    report.setInt(exec_id, seq_num);
+                    report.setChar(side, fields.side_);
+                    report.setInt(last_qty, fields.qty_);
+                    report.setDecimal(last_px, fields.price_, PRICE_DECIMALS);
+                    report.setInt(leaves_qty, 0);
+                    report.setInt(cum_qty, fields.qty_);
+                    report.finalize(seq_num, batch_start);
+                    doNotOptimize(report.data()[report.size() - 2]);
+                }
+                recorder.record(static_cast<double>(getCurrentNanos() - batch_start) / BATCH_SIZE);
+            }
+            const auto elapsed = getCurrentNanos() - start;
+
+            // Round trip the last one through the parser, this also checks the checksum.
+            FIXParser parser(level);
+            FIXMessage message;
+            size_t msg_len = 0;
+            ASSERT(parser.parse(report.data(), report.size(), &message, &msg_len) == FIXParseResult::OK && msg_len == report.size(),
+                   "FIXMessageTemplate produced a message FIXParser rejects.");
+
+            const auto msgs_per_sec = static_cast<double>(num_batches * BATCH_SIZE) * NANOS_TO_SECS / elapsed;
+            context.report(recorder.summarize("fix/encode_" + std::to_string(report.size()) + "B/" + fixSimdLevelToString(level), msgs_per_sec));
+        }
+    }
+}
+
+REGISTER_BENCHMARK("fix/parse", fixParse);
+REGISTER_BENCHMARK("fix/encode", fixEncode);
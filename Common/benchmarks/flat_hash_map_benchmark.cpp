@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+
+#include "benchmark.hpp"
+#include "flat_hash_map.hpp"
+#include "types.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t BATCH_SIZE = 64;
+
+    /// What an order book keeps per live order.
+    struct Order {
+        TickerId ticker_id_ = TickerId_INVALID;
+        ClientId client_id_ = ClientId_INVALID;
+        OrderId client_order_id_ = OrderId_INVALID;
+        Side side_ = Side::INVALID;
+        Price price_ = Price_INVALID;
+        Qty qty_ = Qty_INVALID;
+        Priority priority_ = Priority_INVALID;
+    };
+
+    auto makeOrder(OrderId order_id) {
+        return Order{static_cast<TickerId>(order_id % ME_MAX_TICKERS), static_cast<ClientId>(order_id % 64), order_id,
+                     (order_id % 2) ? Side::BUY : Side::SELL, static_cast<Price>(100 + order_id % 50), static_cast<Qty>(order_id % 1000 + 1), order_id};
+    }
+
+    /// Adapters so one driver runs every map.
+    struct StdMap {
+        std::unordered_map<OrderId, Order> map_;
+        explicit StdMap(size_t max_size) { map_.reserve(max_size); }
+        auto insert(OrderId id, const Order& order) { return map_.emplace(id, order).second; }
+        auto find(OrderId id) -> Order* { auto it = map_.find(id); return it != map_.end() ? &it->second : nullptr; }
+        auto erase(OrderId id) { return map_.erase(id) == 1; }
+    };
+
+    struct FlatMap {
+        FlatHashMap<OrderId, Order> map_;
+        explicit FlatMap(size_t max_size) : map_(max_size) {}
+        auto insert(OrderId id, const Order& order) { return map_.insert(id, order); }
+        auto find(OrderId id) { return map_.find(id); }
+        auto erase(OrderId id) { return map_.erase(id); }
+    };
+
+    struct PooledMap {
+        PooledFlatHashMap<OrderId, Order> map_;
+        explicit PooledMap(size_t max_size) : map_(max_size) {}
+        auto insert(OrderId id, const Order& order) { return map_.emplace(id, order) != nullptr; }
+        auto find(OrderId id) { return map_.find(id); }
+        auto erase(OrderId id) { return map_.erase(id); }
+    };
+
+    /// Order flow churn with live_orders resting: each batch looks up BATCH_SIZE random live orders
+    /// (modifies, executions), cancels them and adds as many new ones. Ids are a sequence like exchange order ids,
+    /// live ones are kept in a vector and picked by walking a shuffled permutation so a batch never repeats one.
+    template<typename Map>
+    auto orderFlowChurn(BenchmarkContext& context, const std::string& name, size_t live_orders) {
+        const auto num_batches = context.iterations(20000);
+
+        Map map(live_orders + BATCH_SIZE);
+        std::vector<OrderId> live(live_orders);
+        OrderId next_order_id = 1;
+
+        LatencyRecorder fill_recorder(live_orders / BATCH_SIZE);
+        for(size_t i = 0; i < live_orders; i += BATCH_SIZE){
+            const auto start = getCurrentNanos();
+            for(size_t j = i; j < std::min(i + BATCH_SIZE, live_orders); j++, next_order_id++){
+                live[j] = next_order_id;
+                map.insert(next_order_id, makeOrder(next_order_id));
+            }
+            fill_recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+
+        std::vector<size_t> permutation(live_orders);
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::shuffle(permutation.begin(), permutation.end(), std::mt19937_64(42));
+        size_t next_pick = 0;
+
+        std::vector<size_t> picks(BATCH_SIZE);
+        size_t failures = 0;
+
+        LatencyRecorder insert_recorder(num_batches), find_recorder(num_batches), erase_recorder(num_batches);
+        for(size_t batch = 0; batch < num_batches; batch++){
+            for(auto& pick : picks){
+                pick = permutation[next_pick];
+                next_pick = (next_pick + 1) % live_orders;
+            }
+
+            auto start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++){
+                const auto found = map.find(live[picks[i]]);
+                failures += !found;
+                doNotOptimize(found);
+            }
+            find_recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+
+            // Cancel the picked orders and replace each with a new one in the same live slot.
+            start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++)
+                failures += !map.erase(live[picks[i]]);
+            erase_recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+
+            start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++, next_order_id++){
+                failures += !map.insert(next_order_id, makeOrder(next_order_id));
+                live[picks[i]] = next_order_id;
+            }
+            insert_recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+
+        ASSERT(!failures, name + " failed " + std::to_string(failures) + " operations.");
+
+        const auto suffix = "/live_" + std::to_string(live_orders) + "/" + name;
+        context.report(fill_recorder.summarize("hash_map/fill" + suffix));
+        context.report(find_recorder.summarize("hash_map/find" + suffix));
+        context.report(erase_recorder.summarize("hash_map/erase" + suffix));
+        context.report(insert_recorder.summarize("hash_map/insert" + suffix));
+    }
+
+    auto hashMapChurn(BenchmarkContext& context, size_t live_orders) {
+        orderFlowChurn<StdMap>(context, "unordered_map", live_orders);
+        orderFlowChurn<FlatMap>(context, "flat", live_orders);
+        orderFlowChurn<PooledMap>(context, "flat_pooled", live_orders);
+    }
+}
+
+REGISTER_BENCHMARK("hash_map/churn_10k", [](BenchmarkContext& context){ hashMapChurn(context, 10000); });
+REGISTER_BENCHMARK("hash_map/churn_1M", [](BenchmarkContext& context){ hashMapChurn(context, context.iterations(1000000)); });
@@ -0,0 +1,92 @@
+#include "benchmark.hpp"
+#include "spsc_lf_queue.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t QUEUE_SIZE = 64 * 1024;
+    constexpr size_t BATCH_SIZE = 1024;
+
+    /// Round trip over two queues between the main and worker cores.
+    auto lfQueuePingPong(BenchmarkContext& context) {
+        const auto warmup = context.iterations(10000);
+        const auto iterations = context.iterations(200000);
+
+        LFQueue<size_t> ping(QUEUE_SIZE), pong(QUEUE_SIZE);
+
+        // Named so that it outlives the worker, setAndCreateThread() keeps a reference to it.
+        auto pong_func = [&](){
+            for(size_t i = 0; i < warmup + iterations; i++){
+                spinUntil([&](){ return ping.size() > 0; });
+                const auto value = *ping.getNextReadLocation();
+                ping.updateNextToRead();
+
+                *pong.getNextWriteLocation() = value;
+                pong.updateNextToWrite();
+            }
+        };
+        auto worker = setAndCreateThread(context.config().worker_core_, "Benchmarks/LFQueue pong", pong_func);
+
+        LatencyRecorder recorder(iterations);
+        for(size_t i = 0; i < warmup + iterations; i++){
+            const auto start = getCurrentNanos();
+            *ping.getNextWriteLocation() = i;
+            ping.updateNextToWrite();
+
+            spinUntil([&](){ return pong.size() > 0; });
+            ASSERT(*pong.getNextReadLocation() == i, "LFQueue ping-pong out of order.");
+            pong.updateNextToRead();
+            const auto end = getCurrentNanos();
+
+            if(i >= warmup)
+                recorder.record(end - start);
+        }
+
+        worker->join();
+        delete worker;
+
+        context.report(recorder.summarize("lf_queue/ping_pong_rtt"));
+    }
+
+    /// One way streaming, timed per batch on the producer.
+    auto lfQueueThroughput(BenchmarkContext& context) {
+        const auto num_batches = context.iterations(5000);
+        const auto num_msgs = num_batches * BATCH_SIZE;
+
+        LFQueue<size_t> queue(QUEUE_SIZE);
+        size_t consumer_sum = 0;
+
+        auto consumer_func = [&](){
+            for(size_t i = 0; i < num_msgs; i++){
+                spinUntil([&](){ return queue.size() > 0; });
+                consumer_sum += *queue.getNextReadLocation();
+                queue.updateNextToRead();
+            }
+        };
+        auto worker = setAndCreateThread(context.config().worker_core_, "Benchmarks/LFQueue consumer", consumer_func);
+
+        LatencyRecorder recorder(num_batches);
+        const auto start = getCurrentNanos();
+        for(size_t batch = 0; batch < num_batches; batch++){
+            const auto batch_start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++){
+                spinUntil([&](){ return queue.size() < QUEUE_SIZE - 1; });
+                *queue.getNextWriteLocation() = batch * BATCH_SIZE + i;
+                queue.updateNextToWrite();
+            }
+            recorder.record(static_cast<double>(getCurrentNanos() - batch_start) / BATCH_SIZE);
+        }
+
+        worker->join();
+        delete worker;
+        const auto elapsed = getCurrentNanos() - start;
+
+        ASSERT(consumer_sum == num_msgs * (num_msgs - 1) / 2, "LFQueue consumer checksum mismatch.");
+
+        context.report(recorder.summarize("lf_queue/throughput", num_msgs * static_cast<double>(NANOS_TO_SECS) / elapsed));
+    }
+}
+
+REGISTER_BENCHMARK("lf_queue/ping_pong_rtt", lfQueuePingPong);
+REGISTER_BENCHMARK("lf_queue/throughput", lfQueueThroughput);
@@ -0,0 +1,156 @@
+#include "benchmark.hpp"
+#include "logging.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t BATCH_SIZE = 64;
+
+    /// Waits for the logger thread so the benchmark never overruns the log queue.
+    auto waitForDrain(const Logger& logger, size_t max_pending) {
+        spinUntil([&](){ return logger.pendingSize() <= max_pending; });
+    }
+
+    /// Cost of a log() call on the producing thread.
+    auto loggerPerCall(BenchmarkContext& context) {
+        const auto num_batches = context.iterations(20000);
+
+        Logger logger("logging_benchmark.log");
+        LatencyRecorder recorder(num_batches);
+
+        for(size_t batch = 0; batch < num_batches; batch++){
+            const auto start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++)
+                logger.log("benchmark batch:% i:% value:%\n", batch, i, 3.14);
+            recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+
+            if(logger.pendingSize() > LOG_QUEUE_SIZE / 4) [[unlikely]]
+                waitForDrain(logger, 0);
+        }
+
+        waitForDrain(logger, 0);
+        context.report(recorder.summarize("logger/log_call"));
+    }
+
+    /// Rate at which the logger thread empties a full queue, in elements per second.
+    /// Includes the logger thread's 10ms idle poll.
+    auto loggerDrain(BenchmarkContext& context) {
+        const auto rounds = context.iterations(20);
+        const size_t elements_per_round = LOG_QUEUE_SIZE * 3 / 4;
+
+        Logger logger("logging_benchmark_drain.log");
+        LatencyRecorder recorder(rounds);
+        Nanos total_drain_time = 0;
+
+        for(size_t round = 0; round < rounds; round++){
+            waitForDrain(logger, 0);
+            for(size_t i = 0; i < elements_per_round; i++)
+                logger.pushValue(static_cast<char>('a' + i % 26));
+
+            const auto start = getCurrentNanos();
+            waitForDrain(logger, 0);
+            const auto elapsed = getCurrentNanos() - start;
+
+            total_drain_time += elapsed;
+            recorder.record(static_cast<double>(elapsed) / elements_per_round);
+        }
+
+        context.report(recorder.summarize("logger/drain", rounds * elements_per_round * static_cast<double>(NANOS_TO_SECS) / total_drain_time));
+    }
+
+    /// num_producers threads logging to one MultiProducerLogger, the per call cost on the producers
+    /// (registration happens before timing starts) and the rate at which the merge empties their queues.
+    auto loggerMultiProducer(BenchmarkContext& context, size_t num_producers) {
+        const auto num_batches = context.iterations(20000) / num_producers;
+        const auto records_per_round = LOG_PRODUCER_QUEUE_SIZE / 2 / 32;
+        const auto rounds = context.iterations(10);
+
+        MultiProducerLogger logger("logging_benchmark_mp.log");
+
+        std::atomic<size_t> phase{0}, done{0};
+        std::vector<std::vector<double>> samples(num_producers);
+        std::atomic<size_t> next_producer{0};
+
+        // Named so that it outlives the producers, setAndCreateThread() keeps a reference to it.
+        auto producer_func = [&](){
+            const auto producer = next_producer++;
+            logger.log("producer:% registered\n", producer);
+            done++;
+
+            // Phase 1: timed log() calls. Waits outside the timing keep the queues from overrunning.
+            spinUntil([&](){ return phase == 1; });
+            samples[producer].reserve(num_batches);
+            for(size_t batch = 0; batch < num_batches; batch++){
+                const auto start = getCurrentNanos();
+                for(size_t i = 0; i < BATCH_SIZE; i++)
+                    logger.log("benchmark producer:% batch:% i:% value:%\n", producer, batch, i, 3.14);
+                samples[producer].push_back(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+
+                if(logger.pendingSize() > LOG_PRODUCER_QUEUE_SIZE / 4) [[unlikely]]
+                    spinUntil([&](){ return logger.pendingSize() <= LOG_PRODUCER_QUEUE_SIZE / 8; });
+            }
+            done++;
+
+            // Phase 2 onwards: fill the queue for each drain round.
+            for(size_t round = 0; round < rounds; round++){
+                spinUntil([&](){ return phase == 2 + round; });
+                for(size_t i = 0; i < records_per_round; i++)
+                    logger.log("drain producer:% i:%\n", producer, i);
+                done++;
+            }
+        };
+
+        std::vector<std::thread*> producers;
+        for(size_t i = 0; i < num_producers; i++)
+            producers.push_back(setAndCreateThread(-1, "Benchmarks/Logger producer " + std::to_string(i), producer_func));
+
+        spinUntil([&](){ return done == num_producers; });
+        spinUntil([&](){ return !logger.pendingSize(); });
+        ASSERT(logger.getNumProducers() == num_producers, "Expected " + std::to_string(num_producers) + " producer queues, got " + std::to_string(logger.getNumProducers()));
+
+        done = 0;
+        phase = 1;
+        spinUntil([&](){ return done == num_producers; });
+        spinUntil([&](){ return !logger.pendingSize(); });
+
+        LatencyRecorder call_recorder(num_batches * num_producers);
+        for(const auto& producer_samples : samples){
+            for(const auto sample : producer_samples)
+                call_recorder.record(sample);
+        }
+
+        LatencyRecorder drain_recorder(rounds);
+        size_t total_elements = 0;
+        Nanos total_drain_time = 0;
+        for(size_t round = 0; round < rounds; round++){
+            done = 0;
+            phase = 2 + round;
+            spinUntil([&](){ return done == num_producers; });
+
+            const auto elements = logger.pendingSize();
+            const auto start = getCurrentNanos();
+            spinUntil([&](){ return !logger.pendingSize(); });
+            const auto elapsed = getCurrentNanos() - start;
+
+            total_elements += elements;
+            total_drain_time += elapsed;
+            drain_recorder.record(static_cast<double>(elapsed) / std::max<size_t>(elements, 1));
+        }
+
+        for(auto producer : producers){
+            producer->join();
+            delete producer;
+        }
+
+        const auto suffix = "/producers_" + std::to_string(num_producers);
+        context.report(call_recorder.summarize("logger/mp_log_call" + suffix));
+        context.report(drain_recorder.summarize("logger/mp_drain" + suffix, total_elements * static_cast<double>(NANOS_TO_SECS) / total_drain_time));
+    }
+}
+
+REGISTER_BENCHMARK("logger/log_call", loggerPerCall);
+REGISTER_BENCHMARK("logger/drain", loggerDrain);
+REGISTER_BENCHMARK("logger/mp_producers_1", [](BenchmarkContext& context){ loggerMultiProducer(context, 1); });
+REGISTER_BENCHMARK("logger/mp_producers_2", [](BenchmarkContext& context){ loggerMultiProducer(context, 2); });
+REGISTER_BENCHMARK("logger/mp_producers_4", [](BenchmarkContext& context){ loggerMultiProducer(context, 4); });
@@ -0,0 +1,65 @@
+#include <random>
+
+#include "benchmark.hpp"
+#include "mem_pool.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t POOL_SIZE = 256 * 1024;
+    constexpr size_t BATCH_SIZE = 64;
+
+    struct PoolObject {
+        char data_[64];
+    };
+
+    /// allocate() + deallocate() of a random live object with the pool held at a fixed occupancy.
+    /// Free blocks are scattered, the free list hands them out in random address order.
+    auto mempoolAllocFree(BenchmarkContext& context, double occupancy) {
+        const auto num_batches = context.iterations(20000);
+
+        Mempool<PoolObject> pool(POOL_SIZE);
+        std::mt19937_64 rng(42);
+
+        std::vector<PoolObject*> live;
+        live.reserve(POOL_SIZE);
+        for(size_t i = 0; i < POOL_SIZE; i++)
+            live.push_back(pool.allocate());
+
+        std::shuffle(live.begin(), live.end(), rng);
+        const auto num_live = static_cast<size_t>(occupancy * POOL_SIZE);
+        while(live.size() > num_live){
+            pool.deallocate(live.back());
+            live.pop_back();
+        }
+
+        std::vector<size_t> victims(BATCH_SIZE);
+        LatencyRecorder recorder(num_batches);
+
+        for(size_t batch = 0; batch < num_batches; batch++){
+            for(auto& victim : victims)
+                victim = live.empty() ? 0 : rng() % live.size();
+
+            const auto start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++){
+                auto obj = pool.allocate();
+                doNotOptimize(obj);
+                if(live.empty()){
+                    pool.deallocate(obj);
+                } else {
+                    pool.deallocate(live[victims[i]]);
+                    live[victims[i]] = obj;
+                }
+            }
+            recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+
+        context.report(recorder.summarize("mempool/alloc_free/occupancy_" + std::to_string(static_cast<int>(occupancy * 100))));
+    }
+}
+
+REGISTER_BENCHMARK("mempool/alloc_free/occupancy_0", [](BenchmarkContext& context){ mempoolAllocFree(context, 0); });
+REGISTER_BENCHMARK("mempool/alloc_free/occupancy_50", [](BenchmarkContext& context){ mempoolAllocFree(context, 0.5); });
+REGISTER_BENCHMARK("mempool/alloc_free/occupancy_90", [](BenchmarkContext& context){ mempoolAllocFree(context, 0.9); });
+REGISTER_BENCHMARK("mempool/alloc_free/occupancy_99", [](BenchmarkContext& context){ mempoolAllocFree(context, 0.99); });
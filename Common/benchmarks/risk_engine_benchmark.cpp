@@ -0,0 +1,156 @@
+#include <random>
+
+#include "benchmark.hpp"
+#include "risk_engine.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t BATCH_SIZE = 64;
+    constexpr size_t NUM_ACCOUNTS = 10000;
+    constexpr size_t STREAM_SIZE = 64 * 1024;
+    constexpr Price REFERENCE_PRICE = 45000000;
+
+    /// Limits that most of the synthetic stream passes, a few percent of orders breach each check.
+    auto configure(RiskEngine& engine) {
+        for(ClientId client_id = 0; client_id < NUM_ACCOUNTS; client_id++){
+            engine.setAccountLimits(client_id, {1000, 1000 * (REFERENCE_PRICE + 100000), 1000});
+            for(TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ticker_id++)
+                engine.setPositionLimit(client_id, ticker_id, 20000);
+        }
+        for(TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ticker_id++)
+            engine.setPriceCollar(ticker_id, REFERENCE_PRICE, 500000);
+    }
+
+    /// Orders spread over all accounts and tickers, prices around the reference with outliers past the collar
+    /// and quantities occasionally over the order size limit.
+    auto makeStream() {
+        std::mt19937_64 rng(42);
+        std::vector<RiskOrder> stream(STREAM_SIZE);
+        for(size_t i = 0; i < STREAM_SIZE; i++){
+            const auto r = rng();
+            stream[i] = {static_cast<ClientId>(r % NUM_ACCOUNTS), static_cast<TickerId>((r >> 16) % ME_MAX_TICKERS), i,
+                         ((r >> 24) & 1) ? Side::BUY : Side::SELL,
+                         REFERENCE_PRICE + static_cast<Price>((r >> 32) % 1200000) - 600000,
+                         static_cast<Qty>(1 + (r >> 48) % 1050)};
+        }
+        return stream;
+    }
+
+    /// Fills every accepted order so exposures move with the stream instead of only growing.
+    auto fillAccepted(RiskEngine& engine, const RiskOrder* orders, const RiskRejects* rejects, size_t n) {
+        for(size_t i = 0; i < n; i++){
+            if(!rejects[i])
+                engine.onExecution({RiskExecutionType::FILLED, orders[i].client_id_, orders[i].ticker_id_, orders[i].side_, orders[i].qty_});
+        }
+    }
+
+    /// checkBatch() over bursts of BATCH_SIZE orders, per order cost. Runs the same stream through the scalar
+    /// engine alongside to check that both produce the same decisions.
+    auto riskCheckBatch(BenchmarkContext& context) {
+        const auto num_batches = context.iterations(50000);
+        const auto stream = makeStream();
+
+        for(const auto use_avx2 : {false, true}){
+            if(use_avx2 && !__builtin_cpu_supports("avx2"))
+                continue;
+
+            RiskEngine engine(NUM_ACCOUNTS, RISK_DEFAULT_RATE_WINDOW, use_avx2);
+            RiskEngine reference(NUM_ACCOUNTS, RISK_DEFAULT_RATE_WINDOW, false);
+            configure(engine);
+            configure(reference);
+
+            LatencyRecorder recorder(num_batches);
+            std::array<RiskRejects, BATCH_SIZE> rejects, expected;
+            size_t mismatches = 0, rejected = 0;
+
+            for(size_t batch = 0; batch < num_batches; batch++){
+                const auto orders = stream.data() + (batch * BATCH_SIZE) % STREAM_SIZE;
+                const auto now = getCurrentNanos();
+
+                const auto start = getCurrentNanos();
+                engine.checkBatch(orders, BATCH_SIZE, now, rejects.data());
+                recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+
+                reference.checkBatch(orders, BATCH_SIZE, now, expected.data());
+                for(size_t i = 0; i < BATCH_SIZE; i++){
+                    mismatches += (rejects[i] != expected[i]);
+                    rejected += (rejects[i] != 0);
+                }
+
+                fillAccepted(engine, orders, rejects.data(), BATCH_SIZE);
+                fillAccepted(reference, orders, expected.data(), BATCH_SIZE);
+            }
+
+            ASSERT(!mismatches, "RiskEngine AVX2 and scalar checks disagree on " + std::to_string(mismatches) + " orders.");
+            ASSERT(rejected && rejected < num_batches * BATCH_SIZE, "Synthetic stream should be partly rejected.");
+
+            context.report(recorder.summarize(std::string("risk/check_batch/") + (use_avx2 ? "avx2" : "scalar")));
+        }
+    }
+
+    /// check() one order at a time.
+    auto riskCheckSingle(BenchmarkContext& context) {
+        const auto num_batches = context.iterations(50000);
+        const auto stream = makeStream();
+
+        RiskEngine engine(NUM_ACCOUNTS);
+        configure(engine);
+
+        LatencyRecorder recorder(num_batches);
+        std::array<RiskRejects, BATCH_SIZE> rejects;
+
+        for(size_t batch = 0; batch < num_batches; batch++){
+            const auto orders = stream.data() + (batch * BATCH_SIZE) % STREAM_SIZE;
+            const auto now = getCurrentNanos();
+
+            const auto start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++)
+                rejects[i] = engine.check(orders[i], now);
+            recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+
+            fillAccepted(engine, orders, rejects.data(), BATCH_SIZE);
+        }
+
+        context.report(recorder.summarize("risk/check_single"));
+    }
+
+    /// The risk stage as it runs: bursts arrive on an LFQueue and drain() checks them together.
+    auto riskDrain(BenchmarkContext& context) {
+        const auto num_batches = context.iterations(50000);
+        const auto stream = makeStream();
+
+        RiskEngine engine(NUM_ACCOUNTS);
+        configure(engine);
+        LFQueue<RiskOrder> queue(4 * BATCH_SIZE);
+
+        LatencyRecorder recorder(num_batches);
+        size_t checked = 0;
+
+        const auto begin = getCurrentNanos();
+        for(size_t batch = 0; batch < num_batches; batch++){
+            const auto orders = stream.data() + (batch * BATCH_SIZE) % STREAM_SIZE;
+            for(size_t i = 0; i < BATCH_SIZE; i++){
+                *queue.getNextWriteLocation() = orders[i];
+                queue.updateNextToWrite();
+            }
+
+            const auto start = getCurrentNanos();
+            checked += engine.drain(queue, start, [&engine](const RiskOrder& order, RiskRejects rejects){
+                if(!rejects)
+                    engine.onExecution({RiskExecutionType::FILLED, order.client_id_, order.ticker_id_, order.side_, order.qty_});
+            });
+            recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+        const auto elapsed = getCurrentNanos() - begin;
+
+        ASSERT(checked == num_batches * BATCH_SIZE, "RiskEngine drained " + std::to_string(checked) + " orders.");
+
+        context.report(recorder.summarize("risk/drain_and_fill", checked * static_cast<double>(NANOS_TO_SECS) / elapsed));
+    }
+}
+
+REGISTER_BENCHMARK("risk/check_batch", riskCheckBatch);
+REGISTER_BENCHMARK("risk/check_single", riskCheckSingle);
+REGISTER_BENCHMARK("risk/drain", riskDrain);
@@ -0,0 +1,107 @@
+#include "benchmark.hpp"
+#include "seqlock.hpp"
+#include "types.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t BATCH_SIZE = 64;
+
+    struct BBO {
+        Price bid_price_ = Price_INVALID;
+        Price ask_price_ = Price_INVALID;
+        Qty bid_qty_ = Qty_INVALID;
+        Qty ask_qty_ = Qty_INVALID;
+    };
+
+    /// One writer on the worker core updating the BBO as fast as it can, num_readers readers.
+    /// The main thread is one of the readers and records read latency, the writer records its write cost.
+    /// Every read is checked for tearing.
+    auto seqlockReaders(BenchmarkContext& context, size_t num_readers) {
+        const auto num_batches = context.iterations(50000);
+
+        Seqlock<BBO> bbo;
+        std::atomic<bool> running{true};
+
+        LatencyRecorder write_recorder(1024 * 1024);
+        auto writer_func = [&](){
+            BBO value;
+            for(Price price = 0; running; ){
+                const auto start = getCurrentNanos();
+                for(size_t i = 0; i < BATCH_SIZE; i++, price++){
+                    value = {price, price + 1, static_cast<Qty>(price), static_cast<Qty>(price + 1)};
+                    bbo.write(value);
+                }
+                if(write_recorder.size() < 1024 * 1024)
+                    write_recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+            }
+        };
+
+        // Counted rather than ASSERTed inside the timed loop, ASSERT builds its message on every call.
+        std::atomic<size_t> torn_reads{0};
+        auto isTorn = [](const BBO& value){
+            return value.bid_price_ != Price_INVALID && value.ask_price_ != value.bid_price_ + 1;
+        };
+
+        auto reader_func = [&](){
+            size_t torn = 0;
+            while(running)
+                torn += isTorn(bbo.read());
+            torn_reads += torn;
+        };
+
+        auto writer = setAndCreateThread(context.config().worker_core_, "Benchmarks/Seqlock writer", writer_func);
+
+        std::vector<std::thread*> readers;
+        for(size_t i = 1; i < num_readers; i++)
+            readers.push_back(setAndCreateThread(-1, "Benchmarks/Seqlock reader " + std::to_string(i), reader_func));
+
+        LatencyRecorder read_recorder(num_batches);
+        size_t torn = 0;
+        for(size_t batch = 0; batch < num_batches; batch++){
+            const auto start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++)
+                torn += isTorn(bbo.read());
+            read_recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+        torn_reads += torn;
+
+        running = false;
+        writer->join();
+        delete writer;
+        for(auto reader : readers){
+            reader->join();
+            delete reader;
+        }
+
+        ASSERT(!torn_reads, "Seqlock returned " + std::to_string(torn_reads) + " torn reads.");
+
+        context.report(read_recorder.summarize("seqlock/read/readers_" + std::to_string(num_readers)));
+        context.report(write_recorder.summarize("seqlock/write/readers_" + std::to_string(num_readers)));
+    }
+
+    /// Uncontended write cost, the baseline for the writer impact of readers.
+    auto seqlockWriteOnly(BenchmarkContext& context) {
+        const auto num_batches = context.iterations(50000);
+
+        SeqlockArray<BBO> bbos(ME_MAX_TICKERS);
+        LatencyRecorder recorder(num_batches);
+
+        for(size_t batch = 0; batch < num_batches; batch++){
+            const auto start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++){
+                const auto price = static_cast<Price>(batch * BATCH_SIZE + i);
+                bbos.write(i % ME_MAX_TICKERS, {price, price + 1, 1, 1});
+            }
+            recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+
+        context.report(recorder.summarize("seqlock/write/readers_0"));
+    }
+}
+
+REGISTER_BENCHMARK("seqlock/readers_1", [](BenchmarkContext& context){ seqlockReaders(context, 1); });
+REGISTER_BENCHMARK("seqlock/readers_2", [](BenchmarkContext& context){ seqlockReaders(context, 2); });
+REGISTER_BENCHMARK("seqlock/readers_4", [](BenchmarkContext& context){ seqlockReaders(context, 4); });
+REGISTER_BENCHMARK("seqlock/write_only", seqlockWriteOnly);
@@ -0,0 +1,71 @@
+#include <sys/wait.h>
+
+#include "benchmark.hpp"
+#include "shm_lf_queue.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t QUEUE_SIZE = 64 * 1024;
+
+    /// Same round trip as lf_queue/ping_pong_rtt, with the pong side in a forked process
+    /// that attaches to the queues by name.
+    auto shmLFQueueCrossProcessPingPong(BenchmarkContext& context) {
+        const auto warmup = context.iterations(10000);
+        const auto iterations = context.iterations(200000);
+
+        const std::string ping_name = "/lle_benchmark_ping_" + std::to_string(getpid());
+        const std::string pong_name = "/lle_benchmark_pong_" + std::to_string(getpid());
+
+        ShmLFQueue<size_t> ping(ping_name, QUEUE_SIZE, ShmQueueRole::PRODUCER, true);
+        ShmLFQueue<size_t> pong(pong_name, QUEUE_SIZE, ShmQueueRole::CONSUMER, true);
+
+        const auto child = fork();
+        ASSERT(child >= 0, "fork() failed.");
+
+        if(!child){
+            const auto core_id = context.config().worker_core_;
+            if(core_id >= 0 && !setThreadCore(core_id))
+                FATAL("Failed to set core affinity for ShmLFQueue pong process to " + std::to_string(core_id));
+
+            ShmLFQueue<size_t> child_ping(ping_name, QUEUE_SIZE, ShmQueueRole::CONSUMER, false);
+            ShmLFQueue<size_t> child_pong(pong_name, QUEUE_SIZE, ShmQueueRole::PRODUCER, false);
+
+            for(size_t i = 0; i < warmup + iterations; i++){
+                spinUntil([&](){ return child_ping.size() > 0; });
+                const auto value = *child_ping.getNextReadLocation();
+                child_ping.updateNextToRead();
+
+                *child_pong.getNextWriteLocation() = value;
+                child_pong.updateNextToWrite();
+            }
+
+            _exit(0);
+        }
+
+        LatencyRecorder recorder(iterations);
+        for(size_t i = 0; i < warmup + iterations; i++){
+            const auto start = getCurrentNanos();
+            *ping.getNextWriteLocation() = i;
+            ping.updateNextToWrite();
+
+            spinUntil([&](){ return pong.size() > 0; });
+            ASSERT(*pong.getNextReadLocation() == i, "ShmLFQueue ping-pong out of order.");
+            pong.updateNextToRead();
+            const auto end = getCurrentNanos();
+
+            if(i >= warmup)
+                recorder.record(end - start);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0, "ShmLFQueue pong process failed.");
+        ASSERT(!ping.isPeerAlive(), "ShmLFQueue consumer should not be alive after exit.");
+
+        context.report(recorder.summarize("shm_lf_queue/cross_process_rtt"));
+    }
+}
+
+REGISTER_BENCHMARK("shm_lf_queue/cross_process_rtt", shmLFQueueCrossProcessPingPong);
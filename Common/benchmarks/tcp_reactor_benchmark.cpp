@@ -0,0 +1,157 @@
+#include "benchmark.hpp"
+#include "tcp_reactor_pool.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr int TCP_REACTOR_BENCHMARK_PORT = 12360;
+    constexpr size_t NUM_CLIENTS = 64;
+    constexpr size_t NUM_CLIENT_THREADS = 4;
+    constexpr size_t CLIENT_BUFFER_SIZE = 64 * 1024;
+
+    struct RecvEvent {
+        int fd_ = -1;
+        size_t len_ = 0;
+        Nanos rx_time_ = 0;
+    };
+
+    auto waitForLoggers(const std::vector<const Logger*>& loggers) {
+        for(auto logger : loggers){
+            if(logger->pendingSize() > LOG_QUEUE_SIZE / 4) [[unlikely]]
+                spinUntil([logger](){ return logger->pendingSize() == 0; });
+        }
+    }
+
+    /// One client thread's share of the connections. Each group has its own Logger, a Logger takes a single producer.
+    struct ClientGroup {
+        Logger* logger_ = nullptr;
+        std::vector<TCPSocket*> clients_;
+        size_t received_ = 0;
+        std::thread* thread_ = nullptr;
+    };
+
+    /// NUM_CLIENTS loopback clients each keep one message in flight against num_reactors echo reactors.
+    /// Reports per message round trip and aggregate message rate. The clients are driven by NUM_CLIENT_THREADS
+    /// threads so that the client side does not cap the reactors. Reactors are pinned from the worker core onwards
+    /// and the client threads to the cores after them.
+    auto tcpReactorEcho(BenchmarkContext& context, size_t num_reactors) {
+        const auto rounds = context.iterations(2000);
+        const int port = TCP_REACTOR_BENCHMARK_PORT + num_reactors;
+
+        auto core_id = [&context](size_t i){
+            return context.config().worker_core_ >= 0 ? static_cast<int>((context.config().worker_core_ + i) % std::thread::hardware_concurrency()) : -1;
+        };
+
+        std::vector<int> core_ids;
+        for(size_t i = 0; i < num_reactors; i++)
+            core_ids.push_back(core_id(i));
+
+        TCPReactorPool<RecvEvent> pool("tcp_reactor_benchmark", core_ids, 64 * 1024, [](TCPSocket* socket, Nanos rx_time, LFQueue<RecvEvent>* downstream){
+            socket->send(socket->inbound_data_.data(), socket->next_valid_read_idx_);
+
+            *downstream->getNextWriteLocation() = {socket->getFD(), socket->next_valid_read_idx_, rx_time};
+            downstream->updateNextToWrite();
+
+            socket->next_valid_read_idx_ = 0;
+        }, CLIENT_BUFFER_SIZE);
+        pool.start("lo", port);
+
+        std::vector<const Logger*> loggers;
+        for(size_t i = 0; i < pool.numReactors(); i++)
+            loggers.push_back(&pool.getLogger(i));
+
+        std::vector<ClientGroup> groups(NUM_CLIENT_THREADS);
+        for(size_t t = 0; t < groups.size(); t++){
+            auto& group = groups[t];
+            group.logger_ = new Logger("tcp_reactor_benchmark_clients_" + std::to_string(t) + ".log");
+            loggers.push_back(group.logger_);
+
+            for(size_t i = t; i < NUM_CLIENTS; i += NUM_CLIENT_THREADS){
+                auto client = new TCPSocket(*group.logger_, CLIENT_BUFFER_SIZE);
+                client->setCallback([&group](TCPSocket* socket, Nanos) noexcept {
+                    group.received_ += socket->next_valid_read_idx_;
+                    socket->next_valid_read_idx_ = 0;
+                });
+                client->connect("127.0.0.1", "lo", port, false);
+                group.clients_.push_back(client);
+            }
+        }
+
+        using namespace std::literals::chrono_literals;
+        std::this_thread::sleep_for(100ms);
+
+        const char msg[64] = "TCPReactorPool benchmark message";
+
+        // The main thread starts each round, every client thread sends one message per client and counts
+        // itself finished once all the echoes are back.
+        std::atomic<size_t> started_rounds{0}, finished_groups{0};
+        std::vector<std::function<void()>> client_funcs(groups.size());
+        for(size_t t = 0; t < groups.size(); t++){
+            client_funcs[t] = [&, t](){
+                auto& group = groups[t];
+                for(size_t round = 0; round < rounds; round++){
+                    spinUntil([&](){ return started_rounds > round; });
+
+                    const auto expected = group.received_ + group.clients_.size() * sizeof(msg);
+                    for(auto client : group.clients_){
+                        client->send(msg, sizeof(msg));
+                        client->sendAndRecv();
+                    }
+                    spinUntil([&](){
+                        for(auto client : group.clients_)
+                            client->sendAndRecv();
+                        return group.received_ >= expected;
+                    });
+                    finished_groups++;
+                }
+            };
+            groups[t].thread_ = setAndCreateThread(core_id(num_reactors + t), "Benchmarks/TCPReactor client " + std::to_string(t), client_funcs[t]);
+        }
+
+        LatencyRecorder recorder(rounds);
+        size_t downstream_events = 0;
+        Nanos total_time = 0;
+
+        for(size_t round = 0; round < rounds; round++){
+            const auto start = getCurrentNanos();
+            started_rounds++;
+            spinUntil([&](){ return finished_groups == (round + 1) * groups.size(); });
+            const auto elapsed = getCurrentNanos() - start;
+
+            total_time += elapsed;
+            recorder.record(static_cast<double>(elapsed) / NUM_CLIENTS);
+
+            for(size_t i = 0; i < pool.numReactors(); i++){
+                auto queue = pool.getQueue(i);
+                for(auto event = queue->getNextReadLocation(); queue->size() && event; event = queue->getNextReadLocation()){
+                    downstream_events++;
+                    queue->updateNextToRead();
+                }
+            }
+
+            waitForLoggers(loggers);
+        }
+
+        pool.stop();
+
+        std::cerr << "tcp_reactor/echo/reactors_" << num_reactors << " downstream events:" << downstream_events << " connections per reactor:";
+        for(size_t i = 0; i < pool.numReactors(); i++)
+            std::cerr << " " << pool.getNumSockets(i);
+        std::cerr << std::endl;
+
+        for(auto& group : groups){
+            group.thread_->join();
+            delete group.thread_;
+            for(auto client : group.clients_)
+                delete client;
+            delete group.logger_;
+        }
+
+        context.report(recorder.summarize("tcp_reactor/echo/reactors_" + std::to_string(num_reactors), rounds * NUM_CLIENTS * static_cast<double>(NANOS_TO_SECS) / total_time));
+    }
+}
+
+REGISTER_BENCHMARK("tcp_reactor/echo/reactors_1", [](BenchmarkContext& context){ tcpReactorEcho(context, 1); });
+REGISTER_BENCHMARK("tcp_reactor/echo/reactors_2", [](BenchmarkContext& context){ tcpReactorEcho(context, 2); });
+REGISTER_BENCHMARK("tcp_reactor/echo/reactors_4", [](BenchmarkContext& context){ tcpReactorEcho(context, 4); });
@@ -0,0 +1,66 @@
+#include "benchmark.hpp"
+#include "tcp_server.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr int TCP_BENCHMARK_PORT = 12350;
+
+    /// Client -> TCPServer -> client echo over loopback, both sides driven from the main thread.
+    auto tcpServerLoopbackRtt(BenchmarkContext& context) {
+        const auto warmup = context.iterations(1000);
+        const auto iterations = context.iterations(20000);
+
+        Logger logger("tcp_server_benchmark.log");
+
+        TCPServer server(logger);
+        server.recv_callback_ = [](TCPSocket* socket, Nanos) noexcept {
+            socket->send(socket->inbound_data_.data(), socket->next_valid_read_idx_);
+            socket->next_valid_read_idx_ = 0;
+        };
+        server.recv_finished_callback_ = []() noexcept {};
+        server.listen("lo", TCP_BENCHMARK_PORT);
+
+        size_t client_received = 0;
+        TCPSocket client(logger);
+        client.setCallback([&client_received](TCPSocket* socket, Nanos) noexcept {
+            client_received += socket->next_valid_read_idx_;
+            socket->next_valid_read_idx_ = 0;
+        });
+        client.connect("127.0.0.1", "lo", TCP_BENCHMARK_PORT, false);
+
+        using namespace std::literals::chrono_literals;
+        std::this_thread::sleep_for(10ms);
+        server.poll();
+
+        const char msg[64] = "TCPServer benchmark message";
+        LatencyRecorder recorder(iterations);
+
+        for(size_t i = 0; i < warmup + iterations; i++){
+            const auto expected = client_received + sizeof(msg);
+
+            const auto start = getCurrentNanos();
+            client.send(msg, sizeof(msg));
+            client.sendAndRecv();
+
+            while(client_received < expected){
+                server.poll();
+                server.sendAndRecv();
+                client.sendAndRecv();
+            }
+            const auto end = getCurrentNanos();
+
+            if(i >= warmup)
+                recorder.record(end - start);
+
+            // TCPSocket logs every read and send, do not let that overrun the log queue.
+            if(logger.pendingSize() > LOG_QUEUE_SIZE / 4) [[unlikely]]
+                spinUntil([&](){ return logger.pendingSize() == 0; });
+        }
+
+        context.report(recorder.summarize("tcp_server/loopback_rtt"));
+    }
+}
+
+REGISTER_BENCHMARK("tcp_server/loopback_rtt", tcpServerLoopbackRtt);
@@ -0,0 +1,31 @@
+#include "benchmark.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t BATCH_SIZE = 1000;
+
+    template<typename F>
+    auto clockCost(BenchmarkContext& context, const std::string& name, F&& func) {
+        const auto num_batches = context.iterations(10000);
+        LatencyRecorder recorder(num_batches);
+
+        for(size_t batch = 0; batch < num_batches; batch++){
+            const auto start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++)
+                doNotOptimize(func());
+            recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+
+        context.report(recorder.summarize(name));
+    }
+}
+
+REGISTER_BENCHMARK("clock/getCurrentNanos", [](BenchmarkContext& context){ clockCost(context, "clock/getCurrentNanos", getCurrentNanos); });
+REGISTER_BENCHMARK("clock/steady_clock", [](BenchmarkContext& context){ clockCost(context, "clock/steady_clock", std::chrono::steady_clock::now); });
+REGISTER_BENCHMARK("clock/rdtsc", [](BenchmarkContext& context){ clockCost(context, "clock/rdtsc", rdtsc); });
+REGISTER_BENCHMARK("clock/getCurrentTimeStr", [](BenchmarkContext& context){
+    std::string time_str;
+    clockCost(context, "clock/getCurrentTimeStr", [&time_str]() -> const char* { return getCurrentTimeStr(&time_str).c_str(); });
+});
@@ -0,0 +1,118 @@
+#include <random>
+
+#include "benchmark.hpp"
+#include "timer_wheel.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t BATCH_SIZE = 64;
+    constexpr Nanos TICK_NANOS = 100 * NANOS_TO_MICROS;
+    constexpr Nanos MAX_TIMEOUT = 30 * NANOS_TO_SECS;
+
+    /// Schedule, cancel and expire with live_timers timers outstanding, the deadlines spread uniformly over
+    /// MAX_TIMEOUT like idle timeouts and GTD expiries would be. The wheel runs on virtual time from 0.
+    auto timerWheelLiveTimers(BenchmarkContext& context, size_t live_timers) {
+        const auto num_batches = context.iterations(20000);
+        ASSERT(live_timers >= BATCH_SIZE, "Need at least " + std::to_string(BATCH_SIZE) + " live timers.");
+        const auto suffix = "/live_" + std::to_string(live_timers);
+
+        size_t num_fired = 0;
+        TimerWheel::ExpireCallbackType on_expire = [&num_fired](TimerHandle, uint64_t user_data){
+            num_fired++;
+            doNotOptimize(user_data);
+        };
+
+        // No headroom, the wheel runs full.
+        TimerWheel wheel(live_timers, TICK_NANOS, on_expire, 0);
+
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<Nanos> timeout_dist(NANOS_TO_MILLIS, MAX_TIMEOUT);
+
+        std::vector<TimerHandle> handles(live_timers);
+
+        LatencyRecorder fill_recorder(live_timers / BATCH_SIZE);
+        for(size_t i = 0; i + BATCH_SIZE <= live_timers; i += BATCH_SIZE){
+            const auto start = getCurrentNanos();
+            for(size_t j = i; j < i + BATCH_SIZE; j++)
+                handles[j] = wheel.schedule(timeout_dist(rng), j);
+            fill_recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+        for(size_t j = live_timers - live_timers % BATCH_SIZE; j < live_timers; j++)
+            handles[j] = wheel.schedule(timeout_dist(rng), j);
+        context.report(fill_recorder.summarize("timer_wheel/schedule" + suffix));
+
+        // Re-arm: cancel a random live timer and schedule its replacement, the heartbeat pattern.
+        // Walk a random permutation so the timers in a batch are distinct.
+        std::vector<size_t> order(live_timers);
+        for(size_t i = 0; i < live_timers; i++)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), rng);
+        std::vector<size_t> indices(BATCH_SIZE);
+        std::vector<Nanos> deadlines(BATCH_SIZE);
+
+        LatencyRecorder cancel_recorder(num_batches), rearm_recorder(num_batches);
+        size_t failed_cancels = 0;
+        for(size_t batch = 0; batch < num_batches; batch++){
+            for(size_t i = 0; i < BATCH_SIZE; i++){
+                indices[i] = order[(batch * BATCH_SIZE + i) % live_timers];
+                deadlines[i] = timeout_dist(rng);
+            }
+
+            auto start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++)
+                failed_cancels += !wheel.cancel(handles[indices[i]]);
+            cancel_recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+
+            start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++)
+                handles[indices[i]] = wheel.schedule(deadlines[i], indices[i]);
+            rearm_recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+        ASSERT(!failed_cancels && wheel.size() == live_timers, "Timer wheel lost timers: " + std::to_string(wheel.size()) + " failed_cancels:" + std::to_string(failed_cancels));
+        context.report(cancel_recorder.summarize("timer_wheel/cancel" + suffix));
+        context.report(rearm_recorder.summarize("timer_wheel/schedule_rearm" + suffix));
+
+        // Run virtual time to the end in event loop sized steps, cost per expired timer including cascades.
+        const auto step = MAX_TIMEOUT / static_cast<Nanos>(context.iterations(100000));
+        LatencyRecorder expire_recorder(MAX_TIMEOUT / std::max<Nanos>(step, 1));
+        const auto expire_start = getCurrentNanos();
+        for(Nanos now = 0; now <= MAX_TIMEOUT + TICK_NANOS; now += std::max<Nanos>(step, 1)){
+            const auto start = getCurrentNanos();
+            const auto fired = wheel.advance(now);
+            const auto elapsed = getCurrentNanos() - start;
+            if(fired)
+                expire_recorder.record(static_cast<double>(elapsed) / fired);
+        }
+        const auto expire_elapsed = getCurrentNanos() - expire_start;
+
+        ASSERT(!wheel.size() && num_fired == live_timers, "Timer wheel did not expire every timer, left:" + std::to_string(wheel.size()) + " fired:" + std::to_string(num_fired));
+        context.report(expire_recorder.summarize("timer_wheel/expire" + suffix, static_cast<double>(num_fired) * NANOS_TO_SECS / expire_elapsed));
+    }
+
+    /// What TCPServer::poll() pays per loop iteration with timers outstanding but none due.
+    auto timerWheelIdleAdvance(BenchmarkContext& context) {
+        const auto num_batches = context.iterations(100000);
+
+        TimerWheel::ExpireCallbackType on_expire = [](TimerHandle, uint64_t){};
+        TimerWheel wheel(1024, NANOS_TO_MILLIS, on_expire, 0);
+        for(size_t i = 0; i < 1000; i++)
+            wheel.schedule(NANOS_TO_SECS + static_cast<Nanos>(i) * NANOS_TO_MILLIS, i);
+
+        LatencyRecorder recorder(num_batches);
+        for(size_t batch = 0; batch < num_batches; batch++){
+            const auto start = getCurrentNanos();
+            for(size_t i = 0; i < BATCH_SIZE; i++){
+                doNotOptimize(wheel.advance(1));
+                doNotOptimize(wheel.nextDeadline());
+            }
+            recorder.record(static_cast<double>(getCurrentNanos() - start) / BATCH_SIZE);
+        }
+
+        context.report(recorder.summarize("timer_wheel/idle_advance"));
+    }
+}
+
+REGISTER_BENCHMARK("timer_wheel/live_1M", [](BenchmarkContext& context){ timerWheelLiveTimers(context, context.iterations(1000000)); });
+REGISTER_BENCHMARK("timer_wheel/idle_advance", timerWheelIdleAdvance);
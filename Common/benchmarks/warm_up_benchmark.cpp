@@ -0,0 +1,198 @@
+#include "benchmark.hpp"
+#include "fix_encoder.hpp"
+#include "fix_parser.hpp"
+#include "logging.hpp"
+#include "mem_pool.hpp"
+#include "risk_engine.hpp"
+#include "tcp_socket.hpp"
+#include "warm_up.hpp"
+
+using namespace Benchmarks;
+using namespace Common;
+
+namespace {
+    constexpr size_t FIRST_MESSAGES = 1000;
+    constexpr size_t WARM_UP_MESSAGES = 10000;
+    constexpr size_t NUM_ACCOUNTS = 10000;
+    constexpr Price REFERENCE_PRICE = 45000000;
+    constexpr int PRICE_DECIMALS = 4;
+
+    /// NewOrderSingles for client_ids starting at first_client.
+    auto makeOrderStream(size_t num_orders, ClientId first_client) {
+        FIXMessageTemplate order("FIX.4.4", "D", "CLIENT0001", "LLENGINE");
+        const auto account = order.addVariableField(1, 6);
+        const auto cl_ord_id = order.addVariableField(FIX_TAG_CL_ORD_ID, 12);
+        order.addField(FIX_TAG_SYMBOL, "3");
+        const auto side = order.addVariableField(FIX_TAG_SIDE, 1);
+        const auto qty = order.addVariableField(FIX_TAG_ORDER_QTY, 6);
+        order.addField(40, "2");
+        const auto price = order.addVariableField(FIX_TAG_PRICE, 11);
+        order.seal();
+
+        std::vector<std::vector<char>> stream;
+        for(size_t i = 0; i < num_orders; i++){
+            order.setInt(account, (first_client + i * 7919) % NUM_ACCOUNTS);
+            order.setInt(cl_ord_id, i + 1);
+            order.setChar(side, (i % 2) ? '1' : '2');
+            order.setInt(qty, 1 + i % 100);
+            order.setDecimal(price, REFERENCE_PRICE + static_cast<Price>(i % 200) * 2500, PRICE_DECIMALS);
+            order.finalize(i + 1, getCurrentNanos());
+            stream.emplace_back(order.data(), order.data() + order.size());
+        }
+        return stream;
+    }
+
+    /// Inbound NewOrderSingle to outbound ExecutionReport: parse, risk check, order pool, encode into the socket
+    /// buffer and log, the path whose first messages the warm-up is for.
+    class OrderPipeline {
+        private:
+            Logger logger_;
+            FIXParser parser_;
+            FIXMessage message_;
+            LFQueue<RiskOrder> risk_queue_;
+            RiskEngine risk_;
+            Mempool<RiskOrder> orders_;
+            std::vector<RiskOrder*> live_orders_;
+            FIXMessageTemplate report_;
+            size_t report_cl_ord_id_ = 0;
+            size_t report_qty_ = 0;
+            TCPSocket socket_;
+            uint64_t seq_num_ = 1;
+
+        public:
+            OrderPipeline()
+                : logger_("warm_up_benchmark.log"), risk_queue_(RISK_BATCH_SIZE), risk_(NUM_ACCOUNTS),
+                  orders_(2 * (FIRST_MESSAGES + WARM_UP_MESSAGES)), report_("FIX.4.4", "8", "LLENGINE", "CLIENT0001"), socket_(logger_) {
+                report_cl_ord_id_ = report_.addVariableField(FIX_TAG_CL_ORD_ID, 12);
+                report_.addField(150, "0");
+                report_.addField(39, "0");
+                report_qty_ = report_.addVariableField(151, 6);
+                report_.seal();
+
+                live_orders_.reserve(FIRST_MESSAGES + WARM_UP_MESSAGES);
+
+                for(ClientId client_id = 0; client_id < NUM_ACCOUNTS; client_id++){
+                    risk_.setAccountLimits(client_id, {1000, 1000 * 2 * REFERENCE_PRICE, 1000});
+                    for(TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ticker_id++)
+                        risk_.setPositionLimit(client_id, ticker_id, 100000);
+                }
+                for(TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ticker_id++)
+                    risk_.setPriceCollar(ticker_id, REFERENCE_PRICE, REFERENCE_PRICE / 10);
+            }
+
+            /// Returns whether the order was accepted.
+            auto onMessage(const std::vector<char>& data) noexcept {
+                size_t msg_len = 0;
+                parser_.parse(data.data(), data.size(), &message_, &msg_len);
+
+                auto order = risk_queue_.getNextWriteLocation();
+                *order = {static_cast<ClientId>(message_.getInt(1)), static_cast<TickerId>(message_.getInt(FIX_TAG_SYMBOL)),
+                          static_cast<OrderId>(message_.getInt(FIX_TAG_CL_ORD_ID)), (message_.getChar(FIX_TAG_SIDE) == '1') ? Side::BUY : Side::SELL,
+                          message_.getDecimal(FIX_TAG_PRICE, PRICE_DECIMALS), static_cast<Qty>(message_.getInt(FIX_TAG_ORDER_QTY))};
+                risk_queue_.updateNextToWrite();
+
+                auto accepted = false;
+                risk_.drain(risk_queue_, getCurrentNanos(), [this, &accepted](const RiskOrder& order, RiskRejects rejects){
+                    accepted = !rejects;
+                    if(!accepted)
+                        return;
+
+                    live_orders_.push_back(orders_.allocate(order));
+
+                    report_.setInt(report_cl_ord_id_, order.order_id_);
+                    report_.setInt(report_qty_, order.qty_);
+                    report_.finalize(seq_num_++, getCurrentNanos());
+                    socket_.send(report_.data(), report_.size());
+
+                    logger_.log("accepted % seq:%\n", order.order_id_, seq_num_);
+                });
+                return accepted;
+            }
+
+            /// Undoes the side effects of the messages so far.
+            auto discard() noexcept {
+                risk_.resetExposures();
+                for(auto order : live_orders_)
+                    orders_.deallocate(order);
+                live_orders_.clear();
+                socket_.next_valid_write_idx_ = 0;
+                seq_num_ = 1;
+            }
+
+            auto declareHotMemory(WarmUp& warm_up) noexcept {
+                risk_queue_.declareHotMemory(warm_up, "risk queue");
+                risk_.declareHotMemory(warm_up, "risk");
+                orders_.declareHotMemory(warm_up, "orders");
+                socket_.declareHotMemory(warm_up, "socket");
+                logger_.declareHotMemory(warm_up, "logger");
+            }
+
+            auto pendingLogSize() const noexcept {
+                return logger_.pendingSize();
+            }
+    };
+
+    /// Writes a buffer larger than the last level cache so each run starts with cold caches.
+    auto evictCaches() {
+        static std::vector<char> scratch(64 * 1024 * 1024);
+        for(size_t i = 0; i < scratch.size(); i += 64)
+            scratch[i]++;
+        doNotOptimize(scratch[0]);
+    }
+
+    /// Latency of each of the first FIRST_MESSAGES through a freshly built pipeline, with and without warm-up,
+    /// and again on the same pipeline as the steady state reference. mlockall() is not attempted, it would pin
+    /// everything the benchmark process has mapped, cache eviction buffer included. Run this benchmark on its own
+    /// (--filter=warm_up) for a cold start, earlier benchmarks warm up shared code.
+    auto warmUpFirstMessages(BenchmarkContext& context) {
+        const auto stream = makeOrderStream(FIRST_MESSAGES, 0);
+        const auto warm_up_stream = makeOrderStream(WARM_UP_MESSAGES, 1);
+
+        auto measure = [&](OrderPipeline& pipeline, const std::string& name){
+            LatencyRecorder recorder(FIRST_MESSAGES);
+            size_t accepted = 0;
+            for(const auto& message : stream){
+                const auto start = getCurrentNanos();
+                accepted += pipeline.onMessage(message);
+                recorder.record(static_cast<double>(getCurrentNanos() - start));
+            }
+
+            ASSERT(accepted == FIRST_MESSAGES, name + " accepted " + std::to_string(accepted) + " of " + std::to_string(FIRST_MESSAGES) + " orders.");
+            context.report(recorder.summarize("warm_up/first_" + std::to_string(FIRST_MESSAGES) + "/" + name));
+        };
+
+        {
+            auto pipeline = std::make_unique<OrderPipeline>();
+            evictCaches();
+            measure(*pipeline, "cold");
+
+            pipeline->discard();
+            measure(*pipeline, "steady");
+            spinUntil([&](){ return !pipeline->pendingLogSize(); });
+        }
+
+        {
+            auto pipeline = std::make_unique<OrderPipeline>();
+
+            WarmUp warm_up;
+            pipeline->declareHotMemory(warm_up);
+            size_t next = 0;
+            warm_up.addStage("orders", [&](){ pipeline->onMessage(warm_up_stream[next++ % warm_up_stream.size()]); }, [&](){ pipeline->discard(); });
+
+            evictCaches();
+            const auto start = getCurrentNanos();
+            warm_up.run(WARM_UP_MESSAGES, false);
+            // The warm-up's log lines would otherwise be written out during the measurement.
+            spinUntil([&](){ return !pipeline->pendingLogSize(); });
+            const auto warm_up_time = getCurrentNanos() - start;
+
+            std::cout << "warm_up: " << warm_up.getRegions().size() << " regions " << warm_up.getHotBytes() / (1024 * 1024) << "MB "
+                      << warm_up.getPrefaultedPages() << " pages, " << WARM_UP_MESSAGES << " messages in " << warm_up_time / NANOS_TO_MICROS << "us" << std::endl;
+
+            measure(*pipeline, "warm");
+            spinUntil([&](){ return !pipeline->pendingLogSize(); });
+        }
+    }
+}
+
+REGISTER_BENCHMARK("warm_up/first_messages", warmUpFirstMessages);
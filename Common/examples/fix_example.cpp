@@ -0,0 +1,98 @@
+#include <unordered_map>
+
+#include "fix_session.hpp"
+
+using namespace Common;
+
+int main(int argc, char** argv){
+    const size_t num_orders = (argc > 1) ? std::stoul(argv[1]) : 1000;
+
+    Logger logger("fix_example.log");
+
+    FIXGateway gateway(logger, "LLENGINE");
+
+    // One ExecutionReport template per session, built on its first order.
+    std::unordered_map<FIXSession*, std::pair<FIXMessageTemplate*, size_t>> reports;
+    gateway.app_callback_ = [&reports](FIXSession* session, const FIXMessage& message, Nanos){
+        if(message.getMsgType() != "D")
+            return;
+
+        auto& [report, cl_ord_id_slot] = reports[session];
+        if(!report){
+            report = session->createTemplate("8");
+            cl_ord_id_slot = report->addVariableField(FIX_TAG_CL_ORD_ID, 12);
+            report->addField(150, "0");
+            report->addField(39, "0");
+            report->seal();
+        }
+
+        report->setInt(cl_ord_id_slot, message.getInt(FIX_TAG_CL_ORD_ID));
+        session->send(report);
+    };
+    gateway.listen("lo", 12347);
+
+    FIXParser parser;
+    FIXMessage message;
+    size_t acks = 0;
+    bool logged_on = false;
+
+    TCPSocket client(logger);
+    client.setCallback([&](TCPSocket* socket, Nanos){
+        size_t consumed = 0, msg_len = 0;
+        while(parser.parse(socket->inbound_data_.data() + consumed, socket->next_valid_read_idx_ - consumed, &message, &msg_len) == FIXParseResult::OK){
+            logged_on |= (message.getMsgType() == "A");
+            acks += (message.getMsgType() == "8");
+            consumed += msg_len;
+        }
+        memmove(socket->inbound_data_.data(), socket->inbound_data_.data() + consumed, socket->next_valid_read_idx_ - consumed);
+        socket->next_valid_read_idx_ -= consumed;
+    });
+    client.connect("127.0.0.1", "lo", 12347, false);
+
+    uint64_t client_seq_num = 1;
+    auto pump = [&](){
+        client.sendAndRecv();
+        gateway.poll();
+        gateway.sendAndRecv();
+        client.sendAndRecv();
+    };
+
+    FIXMessageTemplate logon("FIX.4.4", "A", "CLIENT0001", "LLENGINE");
+    logon.addField(98, "0");
+    logon.addField(FIX_TAG_HEART_BT_INT, "5");
+    logon.seal();
+    logon.finalize(client_seq_num++, getCurrentNanos());
+    client.send(logon.data(), logon.size());
+
+    while(!logged_on)
+        pump();
+    std::cout << "Logged on, sessions:" << gateway.getNumSessions() << std::endl;
+
+    FIXMessageTemplate order("FIX.4.4", "D", "CLIENT0001", "LLENGINE");
+    const auto cl_ord_id_slot = order.addVariableField(FIX_TAG_CL_ORD_ID, 12);
+    order.addField(FIX_TAG_SYMBOL, "ESZ6");
+    order.addField(FIX_TAG_SIDE, "1");
+    order.addField(FIX_TAG_ORDER_QTY, "10");
+    order.addField(40, "2");
+    order.addField(FIX_TAG_PRICE, "4500.25");
+    order.seal();
+
+    const auto start = getCurrentNanos();
+    for(size_t i = 0; i < num_orders; i++){
+        order.setInt(cl_ord_id_slot, i + 1);
+        order.finalize(client_seq_num++, getCurrentNanos());
+        client.send(order.data(), order.size());
+        pump();
+    }
+    while(acks < num_orders)
+        pump();
+    const auto elapsed = getCurrentNanos() - start;
+
+    std::cout << "Sent " << num_orders << " NewOrderSingles, received " << acks << " ExecutionReports in " << elapsed / NANOS_TO_MICROS << "us"
+              << " round trip avg:" << elapsed / static_cast<Nanos>(num_orders) << "ns" << std::endl;
+
+    for(auto& [session, report] : reports)
+        delete report.first;
+
+    return 0;
+}
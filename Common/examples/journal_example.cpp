@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <unistd.h>
+
+#include "journal.hpp"
+#include "market_update.hpp"
+
+using namespace Common;
+
+int main(int argc, char** argv){
+    const size_t num_records = (argc > 1) ? std::stoul(argv[1]) : 2000000;
+    const std::string prefix = "journal_example";
+
+    // Start from an empty journal on every run.
+    for(size_t segment_idx = 0; unlink(journalSegmentFileName(prefix, segment_idx).c_str()) == 0; segment_idx++);
+
+    std::vector<Nanos> latencies(num_records);
+
+    {
+        Journal<MEMarketUpdate> journal(prefix, 10 * NANOS_TO_MILLIS);
+
+        MEMarketUpdate update{MarketUpdateType::ADD, 0, 0, Side::BUY, 100, 10, 0};
+
+        const auto start = getCurrentNanos();
+        for(size_t i = 0; i < num_records; i++){
+            update.order_id_ = i;
+            update.priority_ = i;
+
+            const auto t0 = getCurrentNanos();
+            journal.append(update);
+            latencies[i] = getCurrentNanos() - t0;
+        }
+        const auto elapsed = getCurrentNanos() - start;
+
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "Appended " << num_records << " records of " << sizeof(JournalRecord<MEMarketUpdate>) << " bytes in " << elapsed / NANOS_TO_MICROS << "us"
+                  << " avg:" << static_cast<double>(elapsed) / num_records << "ns" << std::endl;
+        std::cout << "Append latency incl. clock p50:" << latencies[num_records / 2] << "ns p99:" << latencies[num_records * 99 / 100]
+                  << "ns p99.9:" << latencies[num_records * 999 / 1000] << "ns max:" << latencies.back() << "ns" << std::endl;
+    }
+
+    JournalReader<MEMarketUpdate> reader(prefix);
+    size_t checksum = 0;
+
+    const auto start = getCurrentNanos();
+    const auto num_replayed = reader.replay([&checksum](uint64_t, const MEMarketUpdate& update){
+        checksum += update.order_id_;
+    });
+    const auto elapsed = getCurrentNanos() - start;
+
+    ASSERT(num_replayed == num_records, "Replayed " + std::to_string(num_replayed) + " records, expected " + std::to_string(num_records));
+    ASSERT(checksum == num_records * (num_records - 1) / 2, "Replay checksum mismatch.");
+
+    std::cout << "Replayed " << num_replayed << " records (" << reader.getBytesRead() << " bytes) in " << elapsed / NANOS_TO_MICROS << "us"
+              << " throughput:" << static_cast<double>(reader.getBytesRead()) / elapsed << "GB/s" << std::endl;
+
+    return 0;
+}
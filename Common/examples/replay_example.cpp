@@ -0,0 +1,72 @@
+#include <unistd.h>
+
+#include "time_utils.hpp"
+#include "logging.hpp"
+#include "tcp_server.hpp"
+#include "tcp_replayer.hpp"
+
+int main(int,char**){
+    using namespace Common;
+    Logger logger_("replay_example.log");
+
+    const std::string prefix = "replay_example";
+    for(size_t segment_idx = 0; unlink(journalSegmentFileName(prefix, segment_idx).c_str()) == 0; segment_idx++);
+
+    size_t bytes_received = 0;
+    Nanos last_rx_time = 0;
+    auto tcpRecvCallback = [&logger_, &bytes_received, &last_rx_time](TCPSocket* socket, Nanos rx_time) noexcept {
+        logger_.log("recvCallback socket:% len:% rx:%\n", socket->getFD(), socket->next_valid_read_idx_, rx_time);
+        bytes_received += socket->next_valid_read_idx_;
+        last_rx_time = rx_time;
+        socket->next_valid_read_idx_ = 0;
+    };
+
+    auto tcpRecvFinishedCallback = []() noexcept {};
+
+    {
+        TCPCapture capture(prefix);
+
+        TCPServer server(logger_);
+        server.recv_callback_ = tcpRecvCallback;
+        server.recv_finished_callback_ = tcpRecvFinishedCallback;
+        server.setCapture(&capture);
+        server.listen("lo", 12346);
+
+        std::vector<TCPSocket*> clients(5);
+        for(size_t i = 0; i < clients.size(); i++){
+            clients[i] = new TCPSocket(logger_);
+            clients[i]->setCallback([](TCPSocket*, Nanos) noexcept {});
+            clients[i]->connect("127.0.0.1", "lo", 12346, false);
+            server.poll();
+        }
+
+        using namespace std::literals::chrono_literals;
+        for(int itr = 0; itr < 20; itr++){
+            for(size_t i = 0; i < clients.size(); i++){
+                const std::string client_msg = "CLIENT-[" + std::to_string(i) + "] : Sending " + std::to_string(itr * 100 + i) + std::string(itr * 10, '.');
+                clients[i]->send(client_msg.data(), client_msg.length());
+                clients[i]->sendAndRecv();
+
+                std::this_thread::sleep_for(10ms);
+                server.poll();
+                server.sendAndRecv();
+            }
+        }
+
+        std::cout << "Captured " << bytes_received << " bytes, last ktime:" << last_rx_time << std::endl;
+    }
+
+    TCPReplayer replayer(prefix, logger_);
+    replayer.recv_callback_ = tcpRecvCallback;
+    replayer.recv_finished_callback_ = tcpRecvFinishedCallback;
+
+    for(const auto speed : {1.0, 10.0, 0.0}){
+        bytes_received = 0;
+        const auto start = getCurrentNanos();
+        const auto num_reads = replayer.replay(speed);
+        std::cout << "Replayed " << num_reads << " reads " << bytes_received << " bytes at speed:" << speed
+                  << " in " << (getCurrentNanos() - start) / NANOS_TO_MICROS << "us, last ktime:" << last_rx_time << std::endl;
+    }
+
+    return 0;
+}
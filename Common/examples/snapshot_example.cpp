@@ -0,0 +1,95 @@
+#include "snapshot_synthesizer.hpp"
+#include "market_data_recovery.hpp"
+
+using namespace Common;
+
+int main(int argc, char** argv){
+    const size_t num_orders = (argc > 1) ? std::stoul(argv[1]) : 500000;
+    const size_t gap_seq_num = num_orders / 2;
+    ASSERT(num_orders < ME_MAX_ORDER_IDS, "num_orders should be less than " + std::to_string(ME_MAX_ORDER_IDS));
+
+    Logger logger("snapshot_example.log");
+
+    MDPMarketUpdateLFQueue incremental_updates(ME_MAX_MARKET_UPDATES);
+    MDPMarketUpdateLFQueue snapshot_updates(2 * (num_orders + ME_MAX_TICKERS + 2));
+    MEMarketUpdateLFQueue client_updates(2 * (num_orders + ME_MAX_TICKERS + 2));
+
+    SnapshotSynthesizer synthesizer(&incremental_updates, &snapshot_updates, 1 * NANOS_TO_SECS);
+    MarketDataRecovery recovery(&client_updates, logger, 2 * num_orders);
+
+    synthesizer.start();
+
+    size_t client_received = 0;
+    auto drainClient = [&](){
+        for(auto update = client_updates.getNextReadLocation(); client_updates.size() && update; update = client_updates.getNextReadLocation()){
+            client_received++;
+            client_updates.updateNextToRead();
+        }
+    };
+
+    Nanos publish_time = 0;
+    Nanos gap_detected_time = 0;
+    Nanos recovered_time = 0;
+    Nanos apply_time = 0;
+    size_t snapshot_msgs = 0;
+
+    // The client listens to the snapshot channel only while it is recovering.
+    auto drainSnapshots = [&](){
+        for(auto update = snapshot_updates.getNextReadLocation(); snapshot_updates.size() && update; update = snapshot_updates.getNextReadLocation()){
+            if(recovery.inRecovery()){
+                const auto start = getCurrentNanos();
+                recovery.onSnapshot(*update);
+                apply_time += getCurrentNanos() - start;
+                snapshot_msgs++;
+
+                if(!recovery.inRecovery())
+                    recovered_time = getCurrentNanos();
+            }
+            snapshot_updates.updateNextToRead();
+        }
+    };
+
+    for(size_t seq_num = 1; seq_num <= num_orders; seq_num++){
+        MDPMarketUpdate update;
+        update.seq_num_ = seq_num;
+        update.me_market_update_ = {MarketUpdateType::ADD, seq_num, static_cast<TickerId>(seq_num % ME_MAX_TICKERS), (seq_num % 2) ? Side::BUY : Side::SELL,
+                                    static_cast<Price>(100 + seq_num % 50), static_cast<Qty>(seq_num % 1000 + 1), seq_num};
+
+        while(incremental_updates.size() >= ME_MAX_MARKET_UPDATES - 1)
+            std::this_thread::yield();
+
+        // Steady state cost on the publisher is this one extra queue write.
+        const auto start = getCurrentNanos();
+        *(incremental_updates.getNextWriteLocation()) = update;
+        incremental_updates.updateNextToWrite();
+        publish_time += getCurrentNanos() - start;
+
+        // Simulate a dropped multicast packet.
+        if(seq_num == gap_seq_num)
+            continue;
+
+        recovery.onIncremental(update);
+        if(recovery.inRecovery() && !gap_detected_time)
+            gap_detected_time = getCurrentNanos();
+
+        drainSnapshots();
+        drainClient();
+    }
+
+    std::cout << "Published " << num_orders << " incrementals, synthesizer enqueue cost avg:" << publish_time / static_cast<Nanos>(num_orders) << "ns" << std::endl;
+    std::cout << "Gap at seq:" << gap_seq_num << " in_recovery:" << recovery.inRecovery() << " client_received:" << client_received << std::endl;
+
+    while(recovery.inRecovery()){
+        drainSnapshots();
+        drainClient();
+    }
+
+    std::cout << "Recovered after " << snapshot_msgs << " snapshot msgs. next_exp_inc_seq_num:" << recovery.getNextExpIncSeqNum()
+              << " client_received:" << client_received << std::endl;
+    std::cout << "Recovery time from gap:" << (recovered_time - gap_detected_time) / NANOS_TO_MICROS << "us"
+              << " snapshot processing:" << apply_time / NANOS_TO_MICROS << "us" << std::endl;
+
+    synthesizer.stop();
+
+    return 0;
+}
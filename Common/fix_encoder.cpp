@@ -0,0 +1,114 @@
+#include <ctime>
+
+#include "fix_encoder.hpp"
+
+namespace Common {
+    FIXMessageTemplate::FIXMessageTemplate(const std::string& begin_string, const std::string& msg_type, const std::string& sender_comp_id,
+                                           const std::string& target_comp_id, FIXSimdLevel simd_level)
+        : simd_level_(simd_level), begin_string_(begin_string) {
+        addField(FIX_TAG_MSG_TYPE, msg_type);
+        addField(FIX_TAG_SENDER_COMP_ID, sender_comp_id);
+        addField(FIX_TAG_TARGET_COMP_ID, target_comp_id);
+        seq_num_slot_ = appendSlot(FIX_TAG_MSG_SEQ_NUM, FIX_SEQ_NUM_WIDTH);
+        sending_time_slot_ = appendSlot(FIX_TAG_SENDING_TIME, FIX_SENDING_TIME_WIDTH);
+    }
+
+    auto FIXMessageTemplate::addField(FIXTag tag, const std::string& value) -> void {
+        ASSERT(!sealed_, "FIXMessageTemplate fields can not be added after seal().");
+        body_ += std::to_string(tag) + "=" + value + FIX_SOH;
+    }
+
+    auto FIXMessageTemplate::appendSlot(FIXTag tag, size_t width) -> Slot {
+        ASSERT(!sealed_, "FIXMessageTemplate fields can not be added after seal().");
+        ASSERT(width > 0, "FIXMessageTemplate field " + std::to_string(tag) + " needs a width.");
+
+        body_ += std::to_string(tag) + "=";
+        const Slot s{body_.size(), width};
+        body_ += std::string(width, '0') + FIX_SOH;
+
+        return s;
+    }
+
+    auto FIXMessageTemplate::addVariableField(FIXTag tag, size_t width) -> size_t {
+        slots_.push_back(appendSlot(tag, width));
+        return slots_.size() - 1;
+    }
+
+    auto FIXMessageTemplate::seal() -> void {
+        ASSERT(!sealed_, "FIXMessageTemplate sealed twice.");
+
+        const auto header = "8=" + begin_string_ + FIX_SOH + "9=" + std::to_string(body_.size()) + FIX_SOH;
+        const auto message = header + body_ + "10=000" + FIX_SOH;
+        message_.assign(message.begin(), message.end());
+
+        // Slot offsets were relative to the body.
+        for(auto& s : slots_)
+            s.offset_ += header.size();
+        seq_num_slot_.offset_ += header.size();
+        sending_time_slot_.offset_ += header.size();
+        checksum_offset_ = header.size() + body_.size();
+
+        body_.clear();
+        sealed_ = true;
+    }
+
+    auto FIXMessageTemplate::setDecimal(size_t slot_idx, int64_t value, int decimals) noexcept -> void {
+        const auto& s = slot(slot_idx);
+        if(!decimals){
+            setInt(slot_idx, value);
+            return;
+        }
+
+        const auto negative = (value < 0);
+        const uint64_t abs_value = negative ? -value : value;
+
+        uint64_t scale = 1;
+        for(int i = 0; i < decimals; i++)
+            scale *= 10;
+
+        const auto int_width = static_cast<int64_t>(s.width_) - decimals - 1 - negative;
+        if(int_width < 0) [[unlikely]]
+            FATAL("FIXMessageTemplate decimal slot of width " + std::to_string(s.width_) + " can not hold " + std::to_string(decimals) + " places.");
+
+        auto end = &message_[s.offset_ + s.width_];
+        writeDigits(end, abs_value % scale, decimals);
+        *(end - decimals - 1) = '.';
+
+        if(negative)
+            message_[s.offset_] = '-';
+        if(!writeDigits(end - decimals - 1, abs_value / scale, int_width)) [[unlikely]]
+            FATAL("FIXMessageTemplate value " + std::to_string(value) + " does not fit in width " + std::to_string(s.width_));
+    }
+
+    auto FIXMessageTemplate::writeTimestamp(char* out, Nanos time) noexcept -> void {
+        const auto secs = time / NANOS_TO_SECS;
+
+        // gmtime_r() and strftime() once a second, the millis on every call.
+        if(secs != cached_secs_) [[unlikely]] {
+            const time_t time = secs;
+            tm utc;
+            gmtime_r(&time, &utc);
+
+            char buf[32];
+            strftime(buf, sizeof(buf), "%Y%m%d-%H:%M:%S.", &utc);
+            memcpy(cached_time_, buf, FIX_SENDING_TIME_WIDTH - 3);
+            cached_secs_ = secs;
+        }
+
+        memcpy(out, cached_time_, FIX_SENDING_TIME_WIDTH - 3);
+        writeDigits(out + FIX_SENDING_TIME_WIDTH, (time % NANOS_TO_SECS) / NANOS_TO_MILLIS, 3);
+    }
+
+    auto FIXMessageTemplate::finalize(uint64_t seq_num, Nanos sending_time) noexcept -> void {
+        if(!sealed_) [[unlikely]]
+            FATAL("FIXMessageTemplate finalize() before seal().");
+
+        if(!writeDigits(&message_[seq_num_slot_.offset_ + FIX_SEQ_NUM_WIDTH], seq_num, FIX_SEQ_NUM_WIDTH)) [[unlikely]]
+            FATAL("FIXMessageTemplate MsgSeqNum overflow: " + std::to_string(seq_num));
+
+        writeTimestamp(&message_[sending_time_slot_.offset_], sending_time);
+
+        const auto checksum = fixChecksum(message_.data(), checksum_offset_, simd_level_);
+        writeDigits(&message_[checksum_offset_ + 6], checksum, 3);
+    }
+}
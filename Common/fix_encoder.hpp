@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+
+#include "fix_parser.hpp"
+#include "time_utils.hpp"
+
+namespace Common {
+    /// MsgSeqNum is written zero padded to this width so the layout never changes.
+    constexpr size_t FIX_SEQ_NUM_WIDTH = 9;
+
+    /// SendingTime, YYYYMMDD-HH:MM:SS.sss
+    constexpr size_t FIX_SENDING_TIME_WIDTH = 21;
+
+    /// A prebuilt message whose variable fields have fixed widths, so BodyLength and every offset are
+    /// computed once in seal(). Sending a message patches the variable fields, MsgSeqNum and SendingTime in place
+    /// and recomputes the checksum, nothing else is touched.
+    ///
+    /// Build: addField() / addVariableField() in wire order, then seal(). Send: set*(), finalize(), then data() / size().
+    /// Numeric fields are zero padded to their width, which FIX allows for int, qty and price values.
+    class FIXMessageTemplate final {
+        private:
+            struct Slot {
+                size_t offset_ = 0;
+                size_t width_ = 0;
+            };
+
+            const FIXSimdLevel simd_level_;
+            const std::string begin_string_;
+
+            // Everything after BodyLength up to the checksum, only used until seal().
+            std::string body_;
+
+            std::vector<char> message_;
+            std::vector<Slot> slots_;
+            Slot seq_num_slot_, sending_time_slot_;
+            size_t checksum_offset_ = 0;
+            bool sealed_ = false;
+
+            // SendingTime up to the millis of the last second formatted.
+            int64_t cached_secs_ = -1;
+            char cached_time_[FIX_SENDING_TIME_WIDTH];
+
+            auto writeDigits(char* end, uint64_t value, size_t width) noexcept -> bool {
+                for(size_t i = 0; i < width; i++, value /= 10)
+                    *(end - i - 1) = '0' + (value % 10);
+                return !value;
+            }
+
+            auto slot(size_t slot_idx) noexcept -> const Slot& {
+                if(!sealed_ || slot_idx >= slots_.size()) [[unlikely]]
+                    FATAL("FIXMessageTemplate has no slot " + std::to_string(slot_idx) + " or is not sealed.");
+                return slots_[slot_idx];
+            }
+
+            auto appendSlot(FIXTag tag, size_t width) -> Slot;
+
+            /// Writes time as YYYYMMDD-HH:MM:SS.sss, FIX_SENDING_TIME_WIDTH bytes at out.
+            auto writeTimestamp(char* out, Nanos time) noexcept -> void;
+
+        public:
+            FIXMessageTemplate(const std::string& begin_string, const std::string& msg_type, const std::string& sender_comp_id,
+                               const std::string& target_comp_id, FIXSimdLevel simd_level = bestFIXSimdLevel());
+
+            auto addField(FIXTag tag, const std::string& value) -> void;
+
+            /// Reserves width bytes for a value set on every send, returns the slot to pass to set*().
+            auto addVariableField(FIXTag tag, size_t width) -> size_t;
+
+            auto seal() -> void;
+
+            auto setInt(size_t slot_idx, int64_t value) noexcept -> void {
+                const auto& s = slot(slot_idx);
+                if(value < 0)
+                    message_[s.offset_] = '-';
+                if(!writeDigits(&message_[s.offset_ + s.width_], value < 0 ? -value : value, s.width_ - (value < 0))) [[unlikely]]
+                    FATAL("FIXMessageTemplate value " + std::to_string(value) + " does not fit in width " + std::to_string(s.width_));
+            }
+
+            /// value is fixed point with decimals places, the width includes the '.'.
+            auto setDecimal(size_t slot_idx, int64_t value, int decimals) noexcept -> void;
+
+            /// Values have to fill the slot exactly.
+            auto setString(size_t slot_idx, std::string_view value) noexcept -> void {
+                const auto& s = slot(slot_idx);
+                if(value.size() != s.width_) [[unlikely]]
+                    FATAL("FIXMessageTemplate value " + std::string(value) + " does not match width " + std::to_string(s.width_));
+                memcpy(&message_[s.offset_], value.data(), value.size());
+            }
+
+            auto setChar(size_t slot_idx, char value) noexcept -> void {
+                message_[slot(slot_idx).offset_] = value;
+            }
+
+            /// For UTCTimestamp fields such as OrigSendingTime, the slot width has to be FIX_SENDING_TIME_WIDTH.
+            auto setTimestamp(size_t slot_idx, Nanos time) noexcept -> void {
+                const auto& s = slot(slot_idx);
+                if(s.width_ != FIX_SENDING_TIME_WIDTH) [[unlikely]]
+                    FATAL("FIXMessageTemplate timestamp does not match width " + std::to_string(s.width_));
+                writeTimestamp(&message_[s.offset_], time);
+            }
+
+            /// Writes MsgSeqNum, SendingTime and the checksum. The message is then ready in data() / size().
+            auto finalize(uint64_t seq_num, Nanos sending_time) noexcept -> void;
+
+            auto data() const noexcept {
+                return message_.data();
+            }
+
+            auto size() const noexcept {
+                return message_.size();
+            }
+
+            FIXMessageTemplate() = delete;
+            FIXMessageTemplate(const FIXMessageTemplate&) = delete;
+            FIXMessageTemplate(const FIXMessageTemplate&&) = delete;
+            FIXMessageTemplate& operator=(const FIXMessageTemplate&) = delete;
+            FIXMessageTemplate& operator=(const FIXMessageTemplate&&) = delete;
+    };
+}
@@ -0,0 +1,279 @@
+#include <immintrin.h>
+
+#include "fix_parser.hpp"
+
+namespace Common {
+    namespace {
+        constexpr int64_t POW10[FIX_MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+                                     10000000000, 100000000000, 1000000000000, 10000000000000, 100000000000000,
+                                     1000000000000000, 10000000000000000, 100000000000000000, 1000000000000000000};
+
+        constexpr size_t NO_POS = static_cast<size_t>(-1);
+
+        /// Eight ASCII digits to their value in three multiplies.
+        inline auto parseEightDigits(const char* data) noexcept -> uint64_t {
+            uint64_t value;
+            memcpy(&value, data, sizeof(value));
+            value -= 0x3030303030303030ull;
+            value = (value * 10) + (value >> 8);
+            return (((value & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+                    (((value >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+        }
+
+        inline auto parseDigits(const char* data, size_t len) noexcept -> uint64_t {
+            uint64_t value = 0;
+            for(; len >= 8; data += 8, len -= 8)
+                value = value * 100000000 + parseEightDigits(data);
+            for(; len; data++, len--)
+                value = value * 10 + (*data - '0');
+            return value;
+        }
+
+        /// Walks the delimiter positions of one scanned block and appends the completed fields to message.
+        /// field_start and eq_pos carry the partially scanned field over to the next block.
+        struct FieldIndexer {
+            const char* data_;
+            FIXMessage* message_;
+            size_t field_start_ = 0;
+            size_t eq_pos_ = NO_POS;
+
+            template<typename F>
+            auto onDelimiters(uint64_t mask, size_t base, F&& add_field) noexcept -> bool {
+                for(; mask; mask &= mask - 1){
+                    const auto pos = base + __builtin_ctzll(mask);
+
+                    if(data_[pos] == '='){
+                        // Only the first '=' separates the tag, later ones are part of the value.
+                        if(eq_pos_ == NO_POS)
+                            eq_pos_ = pos;
+                        continue;
+                    }
+
+                    const auto tag_len = eq_pos_ - field_start_;
+                    if(eq_pos_ == NO_POS || !tag_len || tag_len > 9) [[unlikely]]
+                        return false;
+
+                    FIXTag tag = 0;
+                    for(auto tag_ptr = data_ + field_start_; tag_ptr != data_ + eq_pos_; tag_ptr++){
+                        if(*tag_ptr < '0' || *tag_ptr > '9') [[unlikely]]
+                            return false;
+                        tag = tag * 10 + (*tag_ptr - '0');
+                    }
+
+                    if(!add_field(tag, eq_pos_ + 1, pos - eq_pos_ - 1)) [[unlikely]]
+                        return false;
+
+                    field_start_ = pos + 1;
+                    eq_pos_ = NO_POS;
+                }
+
+                return true;
+            }
+        };
+
+        inline auto scalarDelimiterMask(const char* data, size_t len) noexcept -> uint64_t {
+            uint64_t mask = 0;
+            for(size_t i = 0; i < len; i++)
+                mask |= static_cast<uint64_t>(data[i] == '=' || data[i] == FIX_SOH) << i;
+            return mask;
+        }
+
+        template<typename F>
+        auto indexScalar(FieldIndexer& indexer, const char* data, size_t len, F&& add_field) noexcept -> bool {
+            for(size_t base = 0; base < len; base += 64){
+                if(!indexer.onDelimiters(scalarDelimiterMask(data + base, std::min<size_t>(64, len - base)), base, add_field))
+                    return false;
+            }
+            return true;
+        }
+
+        template<typename F>
+        __attribute__((target("sse4.2")))
+        auto indexSSE42(FieldIndexer& indexer, const char* data, size_t len, F&& add_field) noexcept -> bool {
+            const auto delimiters = _mm_setr_epi8('=', FIX_SOH, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+            size_t base = 0;
+            for(; base + 16 <= len; base += 16){
+                const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + base));
+                // Explicit lengths, a '\0' in the data must not end the comparison.
+                const auto mask = _mm_cvtsi128_si32(_mm_cmpestrm(delimiters, 2, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK));
+                if(!indexer.onDelimiters(static_cast<uint32_t>(mask), base, add_field))
+                    return false;
+            }
+
+            return indexer.onDelimiters(scalarDelimiterMask(data + base, len - base), base, add_field);
+        }
+
+        template<typename F>
+        __attribute__((target("avx2")))
+        auto indexAVX2(FieldIndexer& indexer, const char* data, size_t len, F&& add_field) noexcept -> bool {
+            const auto equals = _mm256_set1_epi8('=');
+            const auto soh = _mm256_set1_epi8(FIX_SOH);
+
+            size_t base = 0;
+            for(; base + 32 <= len; base += 32){
+                const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + base));
+                const auto matches = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, equals), _mm256_cmpeq_epi8(chunk, soh));
+                if(!indexer.onDelimiters(static_cast<uint32_t>(_mm256_movemask_epi8(matches)), base, add_field))
+                    return false;
+            }
+
+            return indexer.onDelimiters(scalarDelimiterMask(data + base, len - base), base, add_field);
+        }
+
+        __attribute__((target("sse4.2")))
+        auto checksumSSE42(const char* data, size_t len) noexcept -> uint64_t {
+            const auto zero = _mm_setzero_si128();
+            auto sums = _mm_setzero_si128();
+
+            size_t i = 0;
+            for(; i + 16 <= len; i += 16)
+                sums = _mm_add_epi64(sums, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), zero));
+
+            uint64_t sum = _mm_cvtsi128_si64(sums) + _mm_extract_epi64(sums, 1);
+            for(; i < len; i++)
+                sum += static_cast<uint8_t>(data[i]);
+            return sum;
+        }
+
+        __attribute__((target("avx2")))
+        auto checksumAVX2(const char* data, size_t len) noexcept -> uint64_t {
+            const auto zero = _mm256_setzero_si256();
+            auto sums = _mm256_setzero_si256();
+
+            size_t i = 0;
+            for(; i + 32 <= len; i += 32)
+                sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), zero));
+
+            const auto sums128 = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+            uint64_t sum = _mm_cvtsi128_si64(sums128) + _mm_extract_epi64(sums128, 1);
+            for(; i < len; i++)
+                sum += static_cast<uint8_t>(data[i]);
+            return sum;
+        }
+    }
+
+    auto bestFIXSimdLevel() noexcept -> FIXSimdLevel {
+        static const auto level = __builtin_cpu_supports("avx2") ? FIXSimdLevel::AVX2 :
+                                  __builtin_cpu_supports("sse4.2") ? FIXSimdLevel::SSE42 : FIXSimdLevel::SCALAR;
+        return level;
+    }
+
+    auto fixChecksum(const char* data, size_t len, FIXSimdLevel level) noexcept -> uint8_t {
+        switch(level){
+            case FIXSimdLevel::AVX2:
+                return checksumAVX2(data, len);
+            case FIXSimdLevel::SSE42:
+                return checksumSSE42(data, len);
+            case FIXSimdLevel::SCALAR:
+                break;
+        }
+
+        uint64_t sum = 0;
+        for(size_t i = 0; i < len; i++)
+            sum += static_cast<uint8_t>(data[i]);
+        return sum;
+    }
+
+    auto parseFIXInt(const char* data, size_t len) noexcept -> int64_t {
+        if(len && *data == '-')
+            return -static_cast<int64_t>(parseDigits(data + 1, len - 1));
+
+        return parseDigits(data, len);
+    }
+
+    auto parseFIXDecimal(const char* data, size_t len, int decimals) noexcept -> int64_t {
+        if(decimals < 0 || decimals > FIX_MAX_DECIMALS) [[unlikely]]
+            FATAL("parseFIXDecimal decimals:" + std::to_string(decimals) + " out of range.");
+
+        const auto negative = (len && *data == '-');
+        if(negative){
+            data++;
+            len--;
+        }
+
+        const auto dot = static_cast<const char*>(memchr(data, '.', len));
+        const size_t int_len = dot ? dot - data : len;
+        const size_t frac_len = dot ? std::min<size_t>(len - int_len - 1, decimals) : 0;
+
+        const int64_t value = parseDigits(data, int_len) * POW10[decimals] +
+                              (frac_len ? parseDigits(dot + 1, frac_len) * POW10[decimals - frac_len] : 0);
+
+        return negative ? -value : value;
+    }
+
+    auto FIXParser::indexFields(const char* data, size_t len, FIXMessage* message) const noexcept -> bool {
+        FieldIndexer indexer{data, message};
+        auto add_field = [message](FIXTag tag, size_t offset, size_t value_len){
+            return message->addField(tag, offset, value_len);
+        };
+
+        bool ok = false;
+        switch(simd_level_){
+            case FIXSimdLevel::AVX2:
+                ok = indexAVX2(indexer, data, len, add_field);
+                break;
+            case FIXSimdLevel::SSE42:
+                ok = indexSSE42(indexer, data, len, add_field);
+                break;
+            case FIXSimdLevel::SCALAR:
+                ok = indexScalar(indexer, data, len, add_field);
+                break;
+        }
+
+        // Every field, the checksum included, has to be terminated.
+        return ok && indexer.field_start_ == len;
+    }
+
+    auto FIXParser::parse(const char* data, size_t len, FIXMessage* message, size_t* msg_len) const noexcept -> FIXParseResult {
+        // 8=FIX.4.x<SOH>9=<len><SOH> ... 10=xxx<SOH>
+        if(len < 2)
+            return FIXParseResult::INCOMPLETE;
+        if(data[0] != '8' || data[1] != '=')
+            return FIXParseResult::GARBLED;
+
+        constexpr size_t MAX_BEGIN_STRING_LEN = 16;
+        const auto begin_string_end = static_cast<const char*>(memchr(data + 2, FIX_SOH, std::min(len, MAX_BEGIN_STRING_LEN) - 2));
+        if(!begin_string_end)
+            return (len < MAX_BEGIN_STRING_LEN) ? FIXParseResult::INCOMPLETE : FIXParseResult::GARBLED;
+
+        size_t pos = begin_string_end - data + 1;
+        if(len < pos + 2)
+            return FIXParseResult::INCOMPLETE;
+        if(data[pos] != '9' || data[pos + 1] != '=')
+            return FIXParseResult::GARBLED;
+
+        size_t body_len = 0;
+        for(pos += 2; ; pos++){
+            if(pos == len)
+                return FIXParseResult::INCOMPLETE;
+            if(data[pos] == FIX_SOH)
+                break;
+            if(data[pos] < '0' || data[pos] > '9' || body_len > 100000000) [[unlikely]]
+                return FIXParseResult::GARBLED;
+            body_len = body_len * 10 + (data[pos] - '0');
+        }
+
+        const auto checksum_pos = pos + 1 + body_len;
+        const auto total_len = checksum_pos + FIX_CHECKSUM_FIELD_LEN;
+        if(len < total_len)
+            return FIXParseResult::INCOMPLETE;
+
+        const auto checksum_field = data + checksum_pos;
+        if(checksum_field[0] != '1' || checksum_field[1] != '0' || checksum_field[2] != '=' || checksum_field[6] != FIX_SOH) [[unlikely]]
+            return FIXParseResult::GARBLED;
+
+        if(validate_checksum_){
+            const auto expected = (checksum_field[3] - '0') * 100 + (checksum_field[4] - '0') * 10 + (checksum_field[5] - '0');
+            if(fixChecksum(data, checksum_pos, simd_level_) != expected) [[unlikely]]
+                return FIXParseResult::BAD_CHECKSUM;
+        }
+
+        message->reset(data, total_len);
+        if(!indexFields(data, total_len, message)) [[unlikely]]
+            return FIXParseResult::GARBLED;
+
+        *msg_len = total_len;
+        return FIXParseResult::OK;
+    }
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "macros.hpp"
+
+namespace Common {
+    constexpr char FIX_SOH = '\x01';
+
+    typedef uint32_t FIXTag;
+
+    constexpr FIXTag FIX_TAG_BEGIN_STRING = 8;
+    constexpr FIXTag FIX_TAG_BODY_LENGTH = 9;
+    constexpr FIXTag FIX_TAG_CHECKSUM = 10;
+    constexpr FIXTag FIX_TAG_CL_ORD_ID = 11;
+    constexpr FIXTag FIX_TAG_BEGIN_SEQ_NO = 7;
+    constexpr FIXTag FIX_TAG_END_SEQ_NO = 16;
+    constexpr FIXTag FIX_TAG_MSG_SEQ_NUM = 34;
+    constexpr FIXTag FIX_TAG_MSG_TYPE = 35;
+    constexpr FIXTag FIX_TAG_NEW_SEQ_NO = 36;
+    constexpr FIXTag FIX_TAG_ORDER_QTY = 38;
+    constexpr FIXTag FIX_TAG_POSS_DUP_FLAG = 43;
+    constexpr FIXTag FIX_TAG_PRICE = 44;
+    constexpr FIXTag FIX_TAG_SENDER_COMP_ID = 49;
+    constexpr FIXTag FIX_TAG_SENDING_TIME = 52;
+    constexpr FIXTag FIX_TAG_SIDE = 54;
+    constexpr FIXTag FIX_TAG_SYMBOL = 55;
+    constexpr FIXTag FIX_TAG_TARGET_COMP_ID = 56;
+    constexpr FIXTag FIX_TAG_TEXT = 58;
+    constexpr FIXTag FIX_TAG_HEART_BT_INT = 108;
+    constexpr FIXTag FIX_TAG_TEST_REQ_ID = 112;
+    constexpr FIXTag FIX_TAG_ORIG_SENDING_TIME = 122;
+    constexpr FIXTag FIX_TAG_GAP_FILL_FLAG = 123;
+
+    /// Fields beyond this are rejected as GARBLED.
+    constexpr size_t FIX_MAX_FIELDS = 128;
+
+    /// Tags below this are found through a direct index, higher (user defined) tags by a scan of the fields.
+    constexpr FIXTag FIX_MAX_INDEXED_TAG = 1024;
+
+    /// "10=xxx" + SOH
+    constexpr size_t FIX_CHECKSUM_FIELD_LEN = 7;
+
+    enum class FIXParseResult : int8_t {
+        OK = 0,
+        INCOMPLETE = 1,
+        GARBLED = 2,
+        BAD_CHECKSUM = 3
+    };
+
+    inline auto fixParseResultToString(FIXParseResult result) -> std::string {
+        switch(result){
+            case FIXParseResult::OK:
+                return "OK";
+            case FIXParseResult::INCOMPLETE:
+                return "INCOMPLETE";
+            case FIXParseResult::GARBLED:
+                return "GARBLED";
+            case FIXParseResult::BAD_CHECKSUM:
+                return "BAD_CHECKSUM";
+        }
+
+        return "UNKNOWN";
+    }
+
+    /// Instruction set used to scan for delimiters and sum checksums.
+    enum class FIXSimdLevel : int8_t {
+        SCALAR = 0,
+        SSE42 = 1,
+        AVX2 = 2
+    };
+
+    inline auto fixSimdLevelToString(FIXSimdLevel level) -> std::string {
+        switch(level){
+            case FIXSimdLevel::SCALAR:
+                return "scalar";
+            case FIXSimdLevel::SSE42:
+                return "sse42";
+            case FIXSimdLevel::AVX2:
+                return "avx2";
+        }
+
+        return "unknown";
+    }
+
+    /// Best level the CPU we are running on supports, the build itself needs no -march flags.
+    auto bestFIXSimdLevel() noexcept -> FIXSimdLevel;
+
+    /// Sum of the bytes mod 256, as carried in tag 10.
+    auto fixChecksum(const char* data, size_t len, FIXSimdLevel level) noexcept -> uint8_t;
+
+    /// Plain digits with an optional leading '-'. Eight digits at a time with SWAR, no validation beyond that.
+    auto parseFIXInt(const char* data, size_t len) noexcept -> int64_t;
+
+    /// Most decimal places parseFIXDecimal() scales to, 10^18 is the largest power of ten in an int64_t.
+    constexpr int FIX_MAX_DECIMALS = 18;
+
+    /// Decimal scaled to a fixed point integer with decimals places, extra places are truncated. "101.25", 4 -> 1012500
+    /// decimals must be within 0..FIX_MAX_DECIMALS.
+    auto parseFIXDecimal(const char* data, size_t len, int decimals) noexcept -> int64_t;
+
+    struct FIXField {
+        FIXTag tag_ = 0;
+        uint32_t offset_ = 0;
+        uint32_t len_ = 0;
+    };
+
+    /// Zero copy view of one message: tag -> value offsets into the buffer it was parsed from,
+    /// which has to outlive the view and stay unmodified while it is used.
+    class FIXMessage final {
+        private:
+            const char* data_ = nullptr;
+            size_t len_ = 0;
+
+            FIXField fields_[FIX_MAX_FIELDS];
+            size_t num_fields_ = 0;
+
+            // Field index + 1 for every tag below FIX_MAX_INDEXED_TAG, 0 if the tag is absent.
+            uint8_t tag_index_[FIX_MAX_INDEXED_TAG] = {};
+
+            friend class FIXParser;
+
+            auto reset(const char* data, size_t len) noexcept {
+                // Only the entries we set last time, not the whole index.
+                for(size_t i = 0; i < num_fields_; i++){
+                    if(fields_[i].tag_ < FIX_MAX_INDEXED_TAG)
+                        tag_index_[fields_[i].tag_] = 0;
+                }
+
+                num_fields_ = 0;
+                data_ = data;
+                len_ = len;
+            }
+
+            /// Returns false once FIX_MAX_FIELDS is exceeded.
+            auto addField(FIXTag tag, size_t offset, size_t len) noexcept {
+                if(num_fields_ == FIX_MAX_FIELDS) [[unlikely]]
+                    return false;
+
+                fields_[num_fields_] = {tag, static_cast<uint32_t>(offset), static_cast<uint32_t>(len)};
+                num_fields_++;
+
+                // Repeating groups: the index keeps the first occurrence.
+                if(tag < FIX_MAX_INDEXED_TAG && !tag_index_[tag])
+                    tag_index_[tag] = num_fields_;
+
+                return true;
+            }
+
+        public:
+            FIXMessage() = default;
+
+            auto find(FIXTag tag) const noexcept -> const FIXField* {
+                if(tag < FIX_MAX_INDEXED_TAG) [[likely]]
+                    return tag_index_[tag] ? &fields_[tag_index_[tag] - 1] : nullptr;
+
+                for(size_t i = 0; i < num_fields_; i++){
+                    if(fields_[i].tag_ == tag)
+                        return &fields_[i];
+                }
+
+                return nullptr;
+            }
+
+            auto has(FIXTag tag) const noexcept {
+                return find(tag) != nullptr;
+            }
+
+            /// Empty if the tag is absent.
+            auto getString(FIXTag tag) const noexcept -> std::string_view {
+                const auto field = find(tag);
+                return field ? std::string_view(data_ + field->offset_, field->len_) : std::string_view();
+            }
+
+            /// 0 if the tag is absent.
+            auto getInt(FIXTag tag) const noexcept -> int64_t {
+                const auto field = find(tag);
+                return field ? parseFIXInt(data_ + field->offset_, field->len_) : 0;
+            }
+
+            auto getDecimal(FIXTag tag, int decimals) const noexcept -> int64_t {
+                const auto field = find(tag);
+                return field ? parseFIXDecimal(data_ + field->offset_, field->len_, decimals) : 0;
+            }
+
+            /// First character of the value, '\0' if the tag is absent.
+            auto getChar(FIXTag tag) const noexcept -> char {
+                const auto field = find(tag);
+                return (field && field->len_) ? data_[field->offset_] : '\0';
+            }
+
+            auto getMsgType() const noexcept {
+                return getString(FIX_TAG_MSG_TYPE);
+            }
+
+            auto field(size_t i) const noexcept -> const FIXField& {
+                return fields_[i];
+            }
+
+            auto numFields() const noexcept {
+                return num_fields_;
+            }
+
+            auto data() const noexcept {
+                return data_;
+            }
+
+            auto size() const noexcept {
+                return len_;
+            }
+
+            FIXMessage(const FIXMessage&) = delete;
+            FIXMessage(const FIXMessage&&) = delete;
+            FIXMessage& operator=(const FIXMessage&) = delete;
+            FIXMessage& operator=(const FIXMessage&&) = delete;
+    };
+
+    /// Frames FIX 4.x tag=value messages using BodyLength, validates the checksum and indexes every field in place.
+    /// The delimiter scan and the checksum use SSE4.2 or AVX2 depending on simd_level.
+    class FIXParser final {
+        private:
+            const FIXSimdLevel simd_level_;
+            const bool validate_checksum_;
+
+            auto indexFields(const char* data, size_t len, FIXMessage* message) const noexcept -> bool;
+
+        public:
+            explicit FIXParser(FIXSimdLevel simd_level = bestFIXSimdLevel(), bool validate_checksum = true)
+                : simd_level_(simd_level), validate_checksum_(validate_checksum) {
+                ASSERT(simd_level_ <= bestFIXSimdLevel(), "FIXParser " + fixSimdLevelToString(simd_level_) + " is not supported on this CPU.");
+            }
+
+            /// Parses the message at the start of data into message. On OK *msg_len is the length of the message,
+            /// on GARBLED and BAD_CHECKSUM the caller has to resynchronise, INCOMPLETE needs more bytes.
+            auto parse(const char* data, size_t len, FIXMessage* message, size_t* msg_len) const noexcept -> FIXParseResult;
+
+            auto getSimdLevel() const noexcept {
+                return simd_level_;
+            }
+
+            FIXParser(const FIXParser&) = delete;
+            FIXParser(const FIXParser&&) = delete;
+            FIXParser& operator=(const FIXParser&) = delete;
+            FIXParser& operator=(const FIXParser&&) = delete;
+    };
+}
@@ -0,0 +1,286 @@
+#include "fix_session.hpp"
+
+namespace Common {
+    auto FIXSession::buildAdminTemplates() -> void {
+        logon_ = createTemplate("A");
+        logon_->addField(98, "0");
+        logon_->addField(FIX_TAG_HEART_BT_INT, std::to_string(heartbeat_interval_ / NANOS_TO_SECS));
+        logon_->seal();
+
+        heartbeat_ = createTemplate("0");
+        heartbeat_->seal();
+
+        test_request_ = createTemplate("1");
+        test_req_id_slot_ = test_request_->addVariableField(FIX_TAG_TEST_REQ_ID, FIX_SEQ_NUM_WIDTH);
+        test_request_->seal();
+
+        resend_request_ = createTemplate("2");
+        begin_seq_no_slot_ = resend_request_->addVariableField(FIX_TAG_BEGIN_SEQ_NO, FIX_SEQ_NUM_WIDTH);
+        resend_request_->addField(FIX_TAG_END_SEQ_NO, "0");
+        resend_request_->seal();
+
+        gap_fill_ = createTemplate("4");
+        gap_fill_->addField(FIX_TAG_POSS_DUP_FLAG, "Y");
+        // Required with PossDupFlag=Y.
+        orig_sending_time_slot_ = gap_fill_->addVariableField(FIX_TAG_ORIG_SENDING_TIME, FIX_SENDING_TIME_WIDTH);
+        gap_fill_->addField(FIX_TAG_GAP_FILL_FLAG, "Y");
+        new_seq_no_slot_ = gap_fill_->addVariableField(FIX_TAG_NEW_SEQ_NO, FIX_SEQ_NUM_WIDTH);
+        gap_fill_->seal();
+
+        logout_ = createTemplate("5");
+        logout_->seal();
+    }
+
+    FIXSession::~FIXSession() {
+        delete logon_;
+        delete heartbeat_;
+        delete test_request_;
+        delete resend_request_;
+        delete gap_fill_;
+        delete logout_;
+    }
+
+    FIXGateway::FIXGateway(Logger& logger, const std::string& sender_comp_id, const std::string& begin_string, size_t max_sessions, FIXSimdLevel simd_level)
+        : logger_(logger), begin_string_(begin_string), sender_comp_id_(sender_comp_id), max_sessions_(max_sessions), server_(logger),
+          timer_wheel_(max_sessions, FIX_TIMER_TICK, [this](TimerHandle, uint64_t user_data){ onTimer(reinterpret_cast<FIXSession*>(user_data)); }),
+          parser_(simd_level), sessions_(max_sessions) {
+        server_.recv_callback_ = [this](TCPSocket* socket, Nanos rx_time){ onRecv(socket, rx_time); };
+        server_.recv_finished_callback_ = [](){};
+        server_.disconnect_callback_ = [this](TCPSocket* socket){ onDisconnect(socket); };
+        server_.setTimerWheel(&timer_wheel_);
+    }
+
+    FIXGateway::~FIXGateway() {
+        sessions_.forEach([](const TCPSocket*, FIXSession* session){ delete session; });
+    }
+
+    auto FIXGateway::getSession(TCPSocket* socket) noexcept -> FIXSession* {
+        if(auto session = sessions_.find(socket)) [[likely]]
+            return *session;
+
+        if(sessions_.size() == max_sessions_) [[unlikely]] {
+            logger_.log("%:% %() % session limit % reached, ignoring socket:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), max_sessions_, socket->getFD());
+            return nullptr;
+        }
+
+        auto session = new FIXSession(socket, begin_string_, sender_comp_id_);
+        sessions_.insert(socket, session);
+        return session;
+    }
+
+    auto FIXGateway::onRecv(TCPSocket* socket, Nanos rx_time) noexcept -> void {
+        auto session = getSession(socket);
+        auto data = socket->inbound_data_.data();
+        const auto len = socket->next_valid_read_idx_;
+
+        size_t consumed = 0;
+        while(session && consumed < len){
+            size_t msg_len = 0;
+            const auto result = parser_.parse(data + consumed, len - consumed, &message_, &msg_len);
+
+            if(result == FIXParseResult::INCOMPLETE)
+                break;
+
+            if(result != FIXParseResult::OK) [[unlikely]] {
+                logger_.log("%:% %() % socket:% dropping % message\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                            socket->getFD(), fixParseResultToString(result).c_str());
+
+                // Garbled messages are dropped, resynchronise on the next BeginString.
+                constexpr char begin_string_start[] = {FIX_SOH, '8', '=', 'F', 'I', 'X'};
+                const auto next = static_cast<const char*>(memmem(data + consumed + 1, len - consumed - 1, begin_string_start, sizeof(begin_string_start)));
+                consumed = next ? (next - data + 1) : len;
+                continue;
+            }
+
+            onMessage(session, rx_time);
+            consumed += msg_len;
+        }
+
+        if(!session)
+            consumed = len;
+
+        // Keep a partial message at the front of the buffer for the next read.
+        if(consumed){
+            memmove(data, data + consumed, len - consumed);
+            socket->next_valid_read_idx_ = len - consumed;
+        }
+    }
+
+    auto FIXGateway::onLogon(FIXSession* session) noexcept -> void {
+        session->target_comp_id_ = message_.getString(FIX_TAG_SENDER_COMP_ID);
+
+        const auto heartbeat_secs = message_.getInt(FIX_TAG_HEART_BT_INT);
+        session->heartbeat_interval_ = (heartbeat_secs > 0) ? heartbeat_secs * NANOS_TO_SECS : FIX_DEFAULT_HEARTBEAT_INTERVAL;
+
+        session->buildAdminTemplates();
+        session->state_ = FIXSessionState::LOGGED_ON;
+        session->send(session->logon_);
+
+        session->heartbeat_timer_ = timer_wheel_.schedule(getCurrentNanos() + session->heartbeat_interval_, reinterpret_cast<uint64_t>(session));
+
+        logger_.log("%:% %() % logon socket:% target:% heartbeat:%s\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                    session->socket_->getFD(), session->target_comp_id_.c_str(), session->heartbeat_interval_ / NANOS_TO_SECS);
+    }
+
+    auto FIXGateway::onMessage(FIXSession* session, Nanos rx_time) noexcept -> void {
+        const auto msg_type = message_.getMsgType();
+        const auto seq_num = static_cast<uint64_t>(message_.getInt(FIX_TAG_MSG_SEQ_NUM));
+
+        session->last_recv_time_ = getCurrentNanos();
+        session->test_request_pending_ = false;
+
+        if(session->state_ != FIXSessionState::LOGGED_ON) [[unlikely]] {
+            if(session->state_ == FIXSessionState::CONNECTED && msg_type == "A" && message_.getString(FIX_TAG_TARGET_COMP_ID) == sender_comp_id_){
+                onLogon(session);
+                session->next_in_seq_num_ = seq_num + 1;
+            } else {
+                logger_.log("%:% %() % socket:% state:% ignoring MsgType:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                            session->socket_->getFD(), fixSessionStateToString(session->state_).c_str(), std::string(msg_type).c_str());
+            }
+            return;
+        }
+
+        if(session->resend_pending_ && session->next_in_seq_num_ > session->resend_end_seq_num_)
+            session->resend_pending_ = false;
+
+        // SequenceReset-Reset sets the next MsgSeqNum whatever this one says, so it is applied ahead of the gap check.
+        if(msg_type == "4" && message_.getChar(FIX_TAG_GAP_FILL_FLAG) != 'Y'){
+            session->next_in_seq_num_ = message_.getInt(FIX_TAG_NEW_SEQ_NO);
+            return;
+        }
+
+        // A ResendRequest is answered ahead of the gap check too: if both sides have a gap and each held the other's
+        // ResendRequest back until its own gap closed, neither gap would ever close.
+        if(msg_type == "2" && seq_num >= session->next_in_seq_num_)
+            onResendRequest(session);
+
+        if(seq_num < session->next_in_seq_num_) [[unlikely]] {
+            if(message_.getChar(FIX_TAG_POSS_DUP_FLAG) != 'Y')
+                logout(session, "MsgSeqNum " + std::to_string(seq_num) + " expected " + std::to_string(session->next_in_seq_num_));
+            return;
+        }
+
+        if(seq_num > session->next_in_seq_num_) [[unlikely]] {
+            // Out of order messages are not queued: ask for everything from the gap on (EndSeqNo 0) and drop this one,
+            // it comes back in the resend. next_in_seq_num_ only moves as the resent messages or a GapFill arrive.
+            if(!session->resend_pending_){
+                session->resend_request_->setInt(session->begin_seq_no_slot_, session->next_in_seq_num_);
+                session->send(session->resend_request_);
+                session->resend_pending_ = true;
+            }
+            session->resend_end_seq_num_ = std::max(session->resend_end_seq_num_, seq_num);
+
+            if(msg_type == "5")
+                logout(session, "Logout from counterparty");
+            return;
+        }
+        session->next_in_seq_num_ = seq_num + 1;
+
+        if(msg_type.size() == 1){
+            switch(msg_type[0]){
+                case '0':
+                    return;
+                case '1':
+                    sendHeartbeat(session, message_.getString(FIX_TAG_TEST_REQ_ID));
+                    return;
+                case '2':
+                    // Already answered above.
+                    return;
+                case '4': {
+                    // A GapFill only ever moves forward, NewSeqNo may equal this MsgSeqNum + 1 but not be lower.
+                    const auto new_seq_no = static_cast<uint64_t>(message_.getInt(FIX_TAG_NEW_SEQ_NO));
+                    if(new_seq_no < session->next_in_seq_num_) [[unlikely]] {
+                        logout(session, "GapFill NewSeqNo " + std::to_string(new_seq_no) + " below expected " + std::to_string(session->next_in_seq_num_));
+                        return;
+                    }
+                    session->next_in_seq_num_ = new_seq_no;
+                    return;
+                }
+                case '5':
+                    logout(session, "Logout from counterparty");
+                    return;
+                case 'A':
+                    return;
+            }
+        }
+
+        if(app_callback_)
+            app_callback_(session, message_, rx_time);
+    }
+
+    auto FIXGateway::onResendRequest(FIXSession* session) noexcept -> void {
+        const auto begin_seq_num = static_cast<uint64_t>(message_.getInt(FIX_TAG_BEGIN_SEQ_NO));
+        if(begin_seq_num && begin_seq_num < session->next_out_seq_num_){
+            // GapFill goes out with the first requested MsgSeqNum. It replaces messages that are not resent, so there is no
+            // original SendingTime to carry and OrigSendingTime is the SendingTime.
+            const auto now = getCurrentNanos();
+            session->gap_fill_->setInt(session->new_seq_no_slot_, session->next_out_seq_num_);
+            session->gap_fill_->setTimestamp(session->orig_sending_time_slot_, now);
+            session->gap_fill_->finalize(begin_seq_num, now);
+            session->socket_->send(session->gap_fill_->data(), session->gap_fill_->size());
+        }
+    }
+
+    auto FIXGateway::sendHeartbeat(FIXSession* session, std::string_view test_req_id) noexcept -> void {
+        if(test_req_id.empty()){
+            session->send(session->heartbeat_);
+            return;
+        }
+
+        // Echoing an arbitrary TestReqID does not fit a fixed width template, this path is rare enough to build one.
+        FIXMessageTemplate reply(begin_string_, "0", sender_comp_id_, session->target_comp_id_, parser_.getSimdLevel());
+        reply.addField(FIX_TAG_TEST_REQ_ID, std::string(test_req_id));
+        reply.seal();
+        session->send(&reply);
+    }
+
+    auto FIXGateway::logout(FIXSession* session, const std::string& reason) noexcept -> void {
+        session->send(session->logout_);
+        session->state_ = FIXSessionState::LOGGED_OUT;
+        timer_wheel_.cancel(session->heartbeat_timer_);
+
+        logger_.log("%:% %() % logout socket:% target:% reason:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                    session->socket_->getFD(), session->target_comp_id_.c_str(), reason.c_str());
+    }
+
+    auto FIXGateway::onDisconnect(TCPSocket* socket) noexcept -> void {
+        const auto found = sessions_.find(socket);
+        if(!found)
+            return;
+
+        const auto session = *found;
+        logger_.log("%:% %() % disconnect socket:% target:% state:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                    socket->getFD(), session->target_comp_id_.c_str(), fixSessionStateToString(session->state_).c_str());
+
+        timer_wheel_.cancel(session->heartbeat_timer_);
+        sessions_.erase(socket);
+        delete session;
+    }
+
+    auto FIXGateway::onTimer(FIXSession* session) noexcept -> void {
+        if(session->state_ != FIXSessionState::LOGGED_ON)
+            return;
+
+        const auto now = getCurrentNanos();
+        const auto interval = session->heartbeat_interval_;
+
+        if(now - session->last_recv_time_ >= interval){
+            if(session->test_request_pending_){
+                if(now - session->last_recv_time_ >= 2 * interval){
+                    logout(session, "No response to TestRequest");
+                    return;
+                }
+            } else {
+                session->test_request_->setInt(session->test_req_id_slot_, session->next_out_seq_num_);
+                session->send(session->test_request_);
+                session->test_request_pending_ = true;
+            }
+        }
+
+        if(now - session->last_send_time_ >= interval)
+            sendHeartbeat(session, {});
+
+        const auto next_deadline = std::min(session->last_send_time_ + interval, session->last_recv_time_ + (session->test_request_pending_ ? 2 : 1) * interval);
+        session->heartbeat_timer_ = timer_wheel_.schedule(std::max(next_deadline, now + FIX_TIMER_TICK), reinterpret_cast<uint64_t>(session));
+    }
+}
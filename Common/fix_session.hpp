@@ -0,0 +1,189 @@
+#pragma once
+
+#include "fix_parser.hpp"
+#include "fix_encoder.hpp"
+#include "tcp_server.hpp"
+#include "timer_wheel.hpp"
+#include "flat_hash_map.hpp"
+
+namespace Common {
+    constexpr size_t FIX_MAX_SESSIONS = 1024;
+
+    /// Used when a Logon carries no HeartBtInt.
+    constexpr Nanos FIX_DEFAULT_HEARTBEAT_INTERVAL = 30 * NANOS_TO_SECS;
+
+    constexpr Nanos FIX_TIMER_TICK = NANOS_TO_MILLIS;
+
+    enum class FIXSessionState : int8_t {
+        CONNECTED = 0,
+        LOGGED_ON = 1,
+        LOGGED_OUT = 2
+    };
+
+    inline auto fixSessionStateToString(FIXSessionState state) -> std::string {
+        switch(state){
+            case FIXSessionState::CONNECTED:
+                return "CONNECTED";
+            case FIXSessionState::LOGGED_ON:
+                return "LOGGED_ON";
+            case FIXSessionState::LOGGED_OUT:
+                return "LOGGED_OUT";
+        }
+
+        return "UNKNOWN";
+    }
+
+    /// Acceptor side state of one counterparty connection, owned by FIXGateway.
+    class FIXSession final {
+        private:
+            friend class FIXGateway;
+
+            TCPSocket* socket_ = nullptr;
+            const std::string begin_string_;
+            const std::string sender_comp_id_;
+            std::string target_comp_id_;
+
+            FIXSessionState state_ = FIXSessionState::CONNECTED;
+            uint64_t next_in_seq_num_ = 1;
+            uint64_t next_out_seq_num_ = 1;
+
+            // Set while a ResendRequest is outstanding, until next_in_seq_num_ passes the highest MsgSeqNum seen in the gap.
+            bool resend_pending_ = false;
+            uint64_t resend_end_seq_num_ = 0;
+
+            Nanos heartbeat_interval_ = FIX_DEFAULT_HEARTBEAT_INTERVAL;
+            Nanos last_recv_time_ = 0;
+            Nanos last_send_time_ = 0;
+            bool test_request_pending_ = false;
+            TimerHandle heartbeat_timer_;
+
+            // Admin messages, built at Logon once the counterparty is known.
+            FIXMessageTemplate* logon_ = nullptr;
+            FIXMessageTemplate* heartbeat_ = nullptr;
+            FIXMessageTemplate* test_request_ = nullptr;
+            size_t test_req_id_slot_ = 0;
+            FIXMessageTemplate* resend_request_ = nullptr;
+            size_t begin_seq_no_slot_ = 0;
+            FIXMessageTemplate* gap_fill_ = nullptr;
+            size_t new_seq_no_slot_ = 0;
+            size_t orig_sending_time_slot_ = 0;
+            FIXMessageTemplate* logout_ = nullptr;
+
+            auto buildAdminTemplates() -> void;
+
+        public:
+            FIXSession(TCPSocket* socket, const std::string& begin_string, const std::string& sender_comp_id)
+                : socket_(socket), begin_string_(begin_string), sender_comp_id_(sender_comp_id) {}
+
+            ~FIXSession();
+
+            /// Application message template to this counterparty with the header filled in.
+            /// The caller adds its fields, seals it and owns it.
+            auto createTemplate(const std::string& msg_type) const -> FIXMessageTemplate* {
+                return new FIXMessageTemplate(begin_string_, msg_type, sender_comp_id_, target_comp_id_);
+            }
+
+            /// Stamps the next MsgSeqNum and the current time into a sealed template and queues it on the socket.
+            auto send(FIXMessageTemplate* message) noexcept -> void {
+                last_send_time_ = getCurrentNanos();
+                message->finalize(next_out_seq_num_++, last_send_time_);
+                socket_->send(message->data(), message->size());
+            }
+
+            auto getState() const noexcept {
+                return state_;
+            }
+
+            auto& getTargetCompId() const noexcept {
+                return target_comp_id_;
+            }
+
+            auto getNextInSeqNum() const noexcept {
+                return next_in_seq_num_;
+            }
+
+            auto getNextOutSeqNum() const noexcept {
+                return next_out_seq_num_;
+            }
+
+            auto getSocket() const noexcept {
+                return socket_;
+            }
+
+            FIXSession() = delete;
+            FIXSession(const FIXSession&) = delete;
+            FIXSession(const FIXSession&&) = delete;
+            FIXSession& operator=(const FIXSession&) = delete;
+            FIXSession& operator=(const FIXSession&&) = delete;
+    };
+
+    /// FIX 4.2 / 4.4 acceptor on a TCPServer. Frames and indexes inbound messages in place in the socket buffers,
+    /// handles the session level messages (Logon, Heartbeat, TestRequest, ResendRequest, SequenceReset, Logout)
+    /// and passes application messages of logged on sessions to app_callback_.
+    /// Heartbeats and TestRequests are driven by a TimerWheel that also sets the TCPServer poll timeout.
+    /// Sent messages are not stored, ResendRequests are answered with a SequenceReset-GapFill.
+    class FIXGateway final {
+        public:
+            /// message points into the socket buffer and is only valid during the call.
+            typedef std::function<void(FIXSession* session, const FIXMessage& message, Nanos rx_time)> AppCallbackType;
+
+        private:
+            Logger& logger_;
+            const std::string begin_string_;
+            const std::string sender_comp_id_;
+            const size_t max_sessions_;
+
+            TCPServer server_;
+            TimerWheel timer_wheel_;
+
+            FIXParser parser_;
+            FIXMessage message_;
+
+            FlatHashMap<const TCPSocket*, FIXSession*> sessions_;
+
+            std::string time_str_;
+
+            auto getSession(TCPSocket* socket) noexcept -> FIXSession*;
+
+            auto onRecv(TCPSocket* socket, Nanos rx_time) noexcept -> void;
+            auto onMessage(FIXSession* session, Nanos rx_time) noexcept -> void;
+            auto onLogon(FIXSession* session) noexcept -> void;
+            auto onResendRequest(FIXSession* session) noexcept -> void;
+            auto onTimer(FIXSession* session) noexcept -> void;
+            auto onDisconnect(TCPSocket* socket) noexcept -> void;
+
+            auto sendHeartbeat(FIXSession* session, std::string_view test_req_id) noexcept -> void;
+            auto logout(FIXSession* session, const std::string& reason) noexcept -> void;
+
+        public:
+            AppCallbackType app_callback_ = nullptr;
+
+            FIXGateway(Logger& logger, const std::string& sender_comp_id, const std::string& begin_string = "FIX.4.4",
+                       size_t max_sessions = FIX_MAX_SESSIONS, FIXSimdLevel simd_level = bestFIXSimdLevel());
+
+            ~FIXGateway();
+
+            auto listen(const std::string& iface, int port) -> void {
+                server_.listen(iface, port);
+            }
+
+            /// Blocks until socket activity or the next heartbeat deadline, see TCPServer::setTimerWheel().
+            auto poll() noexcept -> void {
+                server_.poll();
+            }
+
+            auto sendAndRecv() noexcept -> void {
+                server_.sendAndRecv();
+            }
+
+            auto getNumSessions() const noexcept {
+                return sessions_.size();
+            }
+
+            FIXGateway() = delete;
+            FIXGateway(const FIXGateway&) = delete;
+            FIXGateway(const FIXGateway&&) = delete;
+            FIXGateway& operator=(const FIXGateway&) = delete;
+            FIXGateway& operator=(const FIXGateway&&) = delete;
+    };
+}
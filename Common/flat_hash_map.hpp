@@ -0,0 +1,207 @@
+#pragma once
+
+#include <bit>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "macros.hpp"
+#include "mem_pool.hpp"
+
+namespace Common {
+    /// Longest probe sequence we allow, far beyond what a map at its load limit produces.
+    constexpr size_t FLAT_HASH_MAP_MAX_PROBE = 255;
+
+    /// Fixed capacity open addressing hash map with Robin Hood probing, all memory is allocated in the constructor.
+    /// Capacity is the power of two that keeps max_size elements at or below 80% load.
+    /// erase() shifts the following entries back instead of leaving tombstones, so lookups never degrade with churn.
+    /// Entries move on insert() and erase(), pointers returned by find() are only valid until the next modification,
+    /// see PooledFlatHashMap for stable values. Single threaded.
+    template<typename K, typename V, typename Hash = std::hash<K>>
+    class FlatHashMap final {
+        private:
+            struct Slot {
+                K key_{};
+                V value_{};
+                // Probe distance + 1 from the home slot, 0 when empty.
+                uint8_t dist_ = 0;
+            };
+
+            std::vector<Slot> slots_;
+            const size_t mask_;
+            const int shift_;
+            const size_t max_size_;
+            size_t size_ = 0;
+
+            Hash hash_;
+
+            /// Fibonacci hashing on top of Hash, std::hash of integers and pointers is the identity.
+            auto homeSlot(const K& key) const noexcept -> size_t {
+                return (static_cast<uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ull) >> shift_;
+            }
+
+            auto findSlot(const K& key) const noexcept -> size_t {
+                auto idx = homeSlot(key);
+                for(uint8_t dist = 1; slots_[idx].dist_ >= dist; dist++, idx = (idx + 1) & mask_){
+                    if(slots_[idx].dist_ == dist && slots_[idx].key_ == key)
+                        return idx;
+                }
+                return slots_.size();
+            }
+
+        public:
+            explicit FlatHashMap(size_t max_size)
+                : slots_(std::bit_ceil(std::max<size_t>(max_size + max_size / 4, 2))), mask_(slots_.size() - 1),
+                  shift_(64 - std::countr_zero(slots_.size())), max_size_(max_size) {}
+
+            /// nullptr if the key is absent.
+            auto find(const K& key) noexcept -> V* {
+                const auto idx = findSlot(key);
+                return (idx != slots_.size()) ? &slots_[idx].value_ : nullptr;
+            }
+
+            auto find(const K& key) const noexcept -> const V* {
+                const auto idx = findSlot(key);
+                return (idx != slots_.size()) ? &slots_[idx].value_ : nullptr;
+            }
+
+            auto contains(const K& key) const noexcept {
+                return findSlot(key) != slots_.size();
+            }
+
+            /// Returns false and leaves the map unchanged if the key is already present.
+            auto insert(const K& key, const V& value) noexcept -> bool {
+                if(size_ == max_size_) [[unlikely]]
+                    FATAL("FlatHashMap full, max_size:" + std::to_string(max_size_));
+
+                Slot entry{key, value, 1};
+                auto displaced = false;
+
+                for(auto idx = homeSlot(key); ; idx = (idx + 1) & mask_, entry.dist_++){
+                    auto& slot = slots_[idx];
+
+                    if(!slot.dist_){
+                        slot = std::move(entry);
+                        size_++;
+                        return true;
+                    }
+
+                    // Until we displace an entry we are still probing for the key itself.
+                    if(!displaced && slot.dist_ == entry.dist_ && slot.key_ == key)
+                        return false;
+
+                    // Robin Hood: take the slot from an entry closer to its home than we are to ours.
+                    if(slot.dist_ < entry.dist_){
+                        std::swap(slot, entry);
+                        displaced = true;
+                    }
+
+                    if(entry.dist_ == FLAT_HASH_MAP_MAX_PROBE) [[unlikely]]
+                        FATAL("FlatHashMap probe sequence too long, check the hash function.");
+                }
+            }
+
+            /// Returns false if the key was absent.
+            auto erase(const K& key) noexcept -> bool {
+                auto idx = findSlot(key);
+                if(idx == slots_.size())
+                    return false;
+
+                // Backward shift: pull every following entry that is not in its home slot one step closer.
+                for(auto next = (idx + 1) & mask_; slots_[next].dist_ > 1; idx = next, next = (next + 1) & mask_){
+                    slots_[idx] = std::move(slots_[next]);
+                    slots_[idx].dist_--;
+                }
+
+                slots_[idx] = Slot();
+                size_--;
+                return true;
+            }
+
+            /// Calls func(key, value) for every entry, in no particular order.
+            template<typename F>
+            auto forEach(F&& func) noexcept {
+                for(auto& slot : slots_){
+                    if(slot.dist_)
+                        func(slot.key_, slot.value_);
+                }
+            }
+
+            auto clear() noexcept {
+                for(auto& slot : slots_)
+                    slot = Slot();
+                size_ = 0;
+            }
+
+            auto size() const noexcept {
+                return size_;
+            }
+
+            auto empty() const noexcept {
+                return !size_;
+            }
+
+            auto capacity() const noexcept {
+                return slots_.size();
+            }
+
+            FlatHashMap() = delete;
+            FlatHashMap(const FlatHashMap&) = delete;
+            FlatHashMap(const FlatHashMap&&) = delete;
+            FlatHashMap& operator=(const FlatHashMap&) = delete;
+            FlatHashMap& operator=(const FlatHashMap&&) = delete;
+    };
+
+    /// FlatHashMap of pointers into a Mempool<V>. Values are constructed in place and never move,
+    /// the probed table stays small and dense however large V is.
+    template<typename K, typename V, typename Hash = std::hash<K>>
+    class PooledFlatHashMap final {
+        private:
+            FlatHashMap<K, V*, Hash> map_;
+            Mempool<V> pool_;
+
+        public:
+            explicit PooledFlatHashMap(size_t max_size) : map_(max_size), pool_(max_size) {}
+
+            /// Constructs V(args...) for key, nullptr if the key is already present.
+            template<typename... Args>
+            auto emplace(const K& key, Args&&... args) noexcept -> V* {
+                if(map_.contains(key))
+                    return nullptr;
+
+                auto value = pool_.allocate(std::forward<Args>(args)...);
+                map_.insert(key, value);
+                return value;
+            }
+
+            auto find(const K& key) noexcept -> V* {
+                const auto value = map_.find(key);
+                return value ? *value : nullptr;
+            }
+
+            auto erase(const K& key) noexcept -> bool {
+                const auto value = map_.find(key);
+                if(!value)
+                    return false;
+
+                pool_.deallocate(*value);
+                map_.erase(key);
+                return true;
+            }
+
+            template<typename F>
+            auto forEach(F&& func) noexcept {
+                map_.forEach([&func](const K& key, V* value){ func(key, *value); });
+            }
+
+            auto size() const noexcept {
+                return map_.size();
+            }
+
+            PooledFlatHashMap() = delete;
+            PooledFlatHashMap(const PooledFlatHashMap&) = delete;
+            PooledFlatHashMap(const PooledFlatHashMap&&) = delete;
+            PooledFlatHashMap& operator=(const PooledFlatHashMap&) = delete;
+            PooledFlatHashMap& operator=(const PooledFlatHashMap&&) = delete;
+    };
+}
@@ -0,0 +1,162 @@
+#include <immintrin.h>
+#include <array>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "journal.hpp"
+
+namespace Common {
+    auto journalSegmentFileName(const std::string& prefix, size_t segment_idx) -> std::string {
+        return prefix + "." + std::to_string(segment_idx) + ".journal";
+    }
+
+    namespace {
+        // CRC32C (Castagnoli, reflected 0x82F63B78), the polynomial of the SSE4.2 crc32 instruction.
+        constexpr auto crc32cTable() noexcept {
+            std::array<uint32_t, 256> table{};
+            for(uint32_t i = 0; i < table.size(); i++){
+                auto crc = i;
+                for(int bit = 0; bit < 8; bit++)
+                    crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : (crc >> 1);
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        constexpr auto CRC32C_TABLE = crc32cTable();
+
+        auto crc32cScalar(uint32_t crc, const char* data, size_t len) noexcept -> uint32_t {
+            for(size_t i = 0; i < len; i++)
+                crc = CRC32C_TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+            return crc;
+        }
+
+        __attribute__((target("sse4.2")))
+        auto crc32cSSE42(uint32_t crc, const char* data, size_t len) noexcept -> uint32_t {
+            uint64_t crc64 = crc;
+            size_t i = 0;
+            for(; i + 8 <= len; i += 8){
+                uint64_t word;
+                memcpy(&word, data + i, sizeof(word));
+                crc64 = _mm_crc32_u64(crc64, word);
+            }
+
+            crc = crc64;
+            for(; i < len; i++)
+                crc = _mm_crc32_u8(crc, data[i]);
+            return crc;
+        }
+    }
+
+    auto journalRecordChecksum(uint64_t seq_num, const char* record, size_t record_size) noexcept -> uint32_t {
+        static const auto crc32c = __builtin_cpu_supports("sse4.2") ? crc32cSSE42 : crc32cScalar;
+
+        const auto crc = crc32c(~0u, reinterpret_cast<const char*>(&seq_num), sizeof(seq_num));
+        return ~crc32c(crc, record + JOURNAL_RECORD_BODY_OFFSET, record_size - JOURNAL_RECORD_BODY_OFFSET);
+    }
+
+    auto createJournalSegment(const std::string& prefix, size_t segment_idx, size_t segment_size, uint32_t record_size) -> JournalSegment* {
+        auto segment = new JournalSegment();
+        segment->file_name_ = journalSegmentFileName(prefix, segment_idx);
+        segment->segment_idx_ = segment_idx;
+        segment->size_ = segment_size;
+
+        segment->fd_ = open(segment->file_name_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        ASSERT(segment->fd_ >= 0, "open() failed for journal segment: " + segment->file_name_ + " errno:" + std::string(strerror(errno)));
+
+        // Reserve the blocks up front so a full disk can not SIGBUS the writer.
+        const auto rc = posix_fallocate(segment->fd_, 0, segment_size);
+        ASSERT(rc == 0, "posix_fallocate() failed for journal segment: " + segment->file_name_ + " error:" + std::string(strerror(rc)));
+
+        auto data = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, segment->fd_, 0);
+        ASSERT(data != MAP_FAILED, "mmap() failed for journal segment: " + segment->file_name_ + " errno:" + std::string(strerror(errno)));
+        segment->data_ = reinterpret_cast<char*>(data);
+
+        auto header = new(segment->data_) JournalSegmentHeader();
+        header->record_size_ = record_size;
+        header->segment_idx_ = segment_idx;
+
+        return segment;
+    }
+
+    auto openJournalSegment(const std::string& prefix, size_t segment_idx, uint32_t record_size) -> JournalSegment* {
+        const auto file_name = journalSegmentFileName(prefix, segment_idx);
+
+        const auto fd = open(file_name.c_str(), O_RDONLY);
+        if(fd < 0)
+            return nullptr;
+
+        struct stat st;
+        ASSERT(fstat(fd, &st) == 0, "fstat() failed for journal segment: " + file_name + " errno:" + std::string(strerror(errno)));
+        ASSERT(static_cast<size_t>(st.st_size) >= sizeof(JournalSegmentHeader), "Journal segment too small: " + file_name);
+
+        auto data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        ASSERT(data != MAP_FAILED, "mmap() failed for journal segment: " + file_name + " errno:" + std::string(strerror(errno)));
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+        const auto header = reinterpret_cast<const JournalSegmentHeader*>(data);
+        ASSERT(header->magic_ == JOURNAL_MAGIC && header->version_ == JOURNAL_VERSION, "Journal segment has unknown layout: " + file_name);
+        ASSERT(header->record_size_ == record_size, "Journal segment record size mismatch: " + file_name + " expected:" + std::to_string(record_size) + " found:" + std::to_string(header->record_size_));
+
+        auto segment = new JournalSegment();
+        segment->file_name_ = file_name;
+        segment->segment_idx_ = segment_idx;
+        segment->fd_ = fd;
+        segment->data_ = reinterpret_cast<char*>(data);
+        segment->size_ = st.st_size;
+
+        return segment;
+    }
+
+    auto syncJournalSegment(JournalSegment* segment) noexcept -> void {
+        const auto write_offset = segment->write_offset_.load(std::memory_order_acquire);
+        if(write_offset == segment->synced_offset_)
+            return;
+
+        // msync() wants a page aligned start address.
+        static const size_t page_size = sysconf(_SC_PAGESIZE);
+        const auto start = segment->synced_offset_ & ~(page_size - 1);
+
+        ASSERT(msync(segment->data_ + start, write_offset - start, MS_SYNC) == 0, "msync() failed for journal segment: " + segment->file_name_ + " errno:" + std::string(strerror(errno)));
+        segment->synced_offset_ = write_offset;
+    }
+
+    auto closeJournalSegment(JournalSegment* segment, bool remove) noexcept -> void {
+        syncJournalSegment(segment);
+
+        munmap(segment->data_, segment->size_);
+        close(segment->fd_);
+
+        if(remove)
+            unlink(segment->file_name_.c_str());
+
+        delete segment;
+    }
+
+    auto findJournalEnd(const std::string& prefix, uint32_t record_size, size_t* next_segment_idx, uint64_t* last_seq_num) -> void {
+        *next_segment_idx = 0;
+        *last_seq_num = 0;
+
+        struct stat st;
+        while(stat(journalSegmentFileName(prefix, *next_segment_idx).c_str(), &st) == 0)
+            (*next_segment_idx)++;
+
+        // Walk back past segments that were preallocated but never written to.
+        for(auto segment_idx = *next_segment_idx; segment_idx > 0 && !*last_seq_num; segment_idx--){
+            auto segment = openJournalSegment(prefix, segment_idx - 1, record_size);
+
+            for(auto offset = sizeof(JournalSegmentHeader); offset + record_size <= segment->size_; offset += record_size){
+                const auto record = segment->data_ + offset;
+                const auto seq_num = *reinterpret_cast<const uint64_t*>(record);
+                if(!seq_num || *reinterpret_cast<const uint32_t*>(record + sizeof(uint64_t)) != journalRecordChecksum(seq_num, record, record_size))
+                    break;
+                *last_seq_num = seq_num;
+            }
+
+            closeJournalSegment(segment);
+        }
+    }
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "macros.hpp"
+#include "time_utils.hpp"
+#include "thread_utils.hpp"
+#include "spsc_lf_queue.hpp"
+
+namespace Common {
+    constexpr size_t JOURNAL_SEGMENT_SIZE = 64 * 1024 * 1024;
+
+    constexpr uint64_t JOURNAL_MAGIC = 0x314c4e524a454c4c; // "LLEJRNL1"
+    constexpr uint32_t JOURNAL_VERSION = 2;
+
+    constexpr Nanos JOURNAL_SYNC_POLL_NANOS = 100 * NANOS_TO_MICROS;
+
+    struct alignas(64) JournalSegmentHeader {
+        uint64_t magic_ = JOURNAL_MAGIC;
+        uint32_t version_ = JOURNAL_VERSION;
+        uint32_t record_size_ = 0;
+        uint64_t segment_idx_ = 0;
+    };
+
+    static_assert(sizeof(JournalSegmentHeader) == 64, "JournalSegmentHeader should occupy one cache line.");
+
+    /// On-disk record. seq_num_ is written after the payload, a zero seq_num_ marks the end of the segment.
+    /// checksum_ is the CRC32C of seq_num_ and every byte after checksum_, a record that fails it was torn by a crash.
+    template<typename T>
+    struct JournalRecord {
+        uint64_t seq_num_ = 0;
+        uint32_t checksum_ = 0;
+        T record_;
+    };
+
+    /// Where the bytes covered by checksum_ after seq_num_ start, the same for every T.
+    constexpr size_t JOURNAL_RECORD_BODY_OFFSET = sizeof(uint64_t) + sizeof(uint32_t);
+
+    struct JournalSegment {
+        std::string file_name_;
+        size_t segment_idx_ = 0;
+
+        int fd_ = -1;
+        char* data_ = nullptr;
+        size_t size_ = 0;
+
+        // Published by the writer after every append, read by the sync thread.
+        std::atomic<size_t> write_offset_{sizeof(JournalSegmentHeader)};
+        size_t synced_offset_ = sizeof(JournalSegmentHeader);
+    };
+
+    auto journalSegmentFileName(const std::string& prefix, size_t segment_idx) -> std::string;
+
+    /// CRC32C of seq_num and the record_size - JOURNAL_RECORD_BODY_OFFSET bytes after the checksum of the record
+    /// at record. Uses the SSE4.2 crc32 instruction when the CPU has it.
+    auto journalRecordChecksum(uint64_t seq_num, const char* record, size_t record_size) noexcept -> uint32_t;
+
+    /// Creates, preallocates and maps a new segment for writing. Pages are pre-faulted.
+    auto createJournalSegment(const std::string& prefix, size_t segment_idx, size_t segment_size, uint32_t record_size) -> JournalSegment*;
+
+    /// Maps an existing segment read-only for sequential replay, returns nullptr if it does not exist.
+    auto openJournalSegment(const std::string& prefix, size_t segment_idx, uint32_t record_size) -> JournalSegment*;
+
+    /// msync()s everything appended since the last sync.
+    auto syncJournalSegment(JournalSegment* segment) noexcept -> void;
+
+    auto closeJournalSegment(JournalSegment* segment, bool remove = false) noexcept -> void;
+
+    /// Finds the first unused segment index and the last sequence number written to the journal, ignoring a torn record
+    /// so that the writer reuses its sequence number.
+    auto findJournalEnd(const std::string& prefix, uint32_t record_size, size_t* next_segment_idx, uint64_t* last_seq_num) -> void;
+
+    /// Append-only journal of fixed layout records in memory mapped segment files.
+    /// append() is a copy into the mapped segment and an offset bump. A background thread msync()s
+    /// in batches every durability_lag nanos and keeps the next segment preallocated so a roll is a pointer swap.
+    template<typename T>
+    class Journal final {
+        static_assert(std::is_trivially_copyable_v<T>, "Journal records should be trivially copyable.");
+
+        typedef JournalRecord<T> RecordType;
+        static_assert(offsetof(RecordType, record_) >= JOURNAL_RECORD_BODY_OFFSET, "JournalRecord checksum layout changed.");
+
+        private:
+            const std::string prefix_;
+            const size_t segment_size_;
+            const Nanos durability_lag_;
+
+            // Owned by the writer thread.
+            JournalSegment* segment_ = nullptr;
+            size_t write_offset_ = sizeof(JournalSegmentHeader);
+            uint64_t next_seq_num_ = 1;
+
+            // Segment the sync thread should msync().
+            std::atomic<JournalSegment*> current_segment_{nullptr};
+
+            // Sync thread -> writer: preallocated segments. Writer -> sync thread: full segments to close.
+            LFQueue<JournalSegment*> prepared_segments_;
+            LFQueue<JournalSegment*> retired_segments_;
+            size_t next_segment_idx_ = 0;
+
+            std::atomic<bool> running_{true};
+            std::thread* sync_thread_ = nullptr;
+
+            auto prepareSegment() -> void {
+                *(prepared_segments_.getNextWriteLocation()) = createJournalSegment(prefix_, next_segment_idx_++, segment_size_, sizeof(RecordType));
+                prepared_segments_.updateNextToWrite();
+            }
+
+            auto closeRetiredSegments() noexcept -> void {
+                for(auto segment = retired_segments_.getNextReadLocation(); retired_segments_.size() && segment; segment = retired_segments_.getNextReadLocation()){
+                    closeJournalSegment(*segment);
+                    retired_segments_.updateNextToRead();
+                }
+            }
+
+            auto roll() noexcept -> void {
+                // The sync thread keeps one segment ready, we only wait if the writer outruns it.
+                while(!prepared_segments_.size()) [[unlikely]]
+                    std::this_thread::yield();
+
+                auto retired = segment_;
+
+                segment_ = *(prepared_segments_.getNextReadLocation());
+                prepared_segments_.updateNextToRead();
+                write_offset_ = sizeof(JournalSegmentHeader);
+                current_segment_ = segment_;
+
+                *(retired_segments_.getNextWriteLocation()) = retired;
+                retired_segments_.updateNextToWrite();
+            }
+
+            auto runSync() noexcept -> void {
+                auto last_sync_time = getCurrentNanos();
+
+                while(running_){
+                    // Retired segments first, current_segment_ has already moved past them.
+                    closeRetiredSegments();
+
+                    if(!prepared_segments_.size())
+                        prepareSegment();
+
+                    const auto now = getCurrentNanos();
+                    if(now - last_sync_time >= durability_lag_){
+                        syncJournalSegment(current_segment_);
+                        last_sync_time = now;
+                    }
+
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(JOURNAL_SYNC_POLL_NANOS));
+                }
+            }
+
+        public:
+            Journal(const std::string& prefix, Nanos durability_lag, size_t segment_size = JOURNAL_SEGMENT_SIZE, int sync_core_id = -1)
+                : prefix_(prefix), segment_size_(segment_size), durability_lag_(durability_lag), prepared_segments_(4), retired_segments_(64) {
+                ASSERT(segment_size_ >= sizeof(JournalSegmentHeader) + sizeof(RecordType), "Journal segment size too small: " + std::to_string(segment_size_));
+
+                uint64_t last_seq_num = 0;
+                findJournalEnd(prefix_, sizeof(RecordType), &next_segment_idx_, &last_seq_num);
+                next_seq_num_ = last_seq_num + 1;
+
+                segment_ = createJournalSegment(prefix_, next_segment_idx_++, segment_size_, sizeof(RecordType));
+                current_segment_ = segment_;
+                prepareSegment();
+
+                sync_thread_ = setAndCreateThread(sync_core_id, "Common/Journal " + prefix_, [this](){ runSync(); });
+                ASSERT(sync_thread_ != nullptr, "Failed to start journal sync thread for " + prefix_);
+            }
+
+            ~Journal() {
+                running_ = false;
+                sync_thread_->join();
+                delete sync_thread_;
+
+                closeRetiredSegments();
+                closeJournalSegment(segment_);
+
+                for(auto segment = prepared_segments_.getNextReadLocation(); prepared_segments_.size() && segment; segment = prepared_segments_.getNextReadLocation()){
+                    closeJournalSegment(*segment, true);
+                    prepared_segments_.updateNextToRead();
+                }
+            }
+
+            /// Hot path, returns the sequence number assigned to the record.
+            auto append(const T& record) noexcept -> uint64_t {
+                if(write_offset_ + sizeof(RecordType) > segment_size_) [[unlikely]]
+                    roll();
+
+                auto journal_record = reinterpret_cast<RecordType*>(segment_->data_ + write_offset_);
+                // memcpy() so that padding inside T is written too, the checksum covers it.
+                memcpy(&journal_record->record_, &record, sizeof(T));
+                journal_record->checksum_ = journalRecordChecksum(next_seq_num_, reinterpret_cast<const char*>(journal_record), sizeof(RecordType));
+                // Payload has to be in place before the seq_num_ that makes it visible to replay.
+                std::atomic_signal_fence(std::memory_order_release);
+                journal_record->seq_num_ = next_seq_num_;
+
+                write_offset_ += sizeof(RecordType);
+                segment_->write_offset_.store(write_offset_, std::memory_order_release);
+
+                return next_seq_num_++;
+            }
+
+            auto getNextSeqNum() const noexcept {
+                return next_seq_num_;
+            }
+
+            Journal() = delete;
+            Journal(const Journal &) = delete;
+            Journal(const Journal &&) = delete;
+            Journal& operator=(const Journal &) = delete;
+            Journal& operator=(const Journal &&) = delete;
+    };
+
+    /// Rebuilds state at startup by scanning the mapped segments of a journal sequentially.
+    template<typename T>
+    class JournalReader final {
+        typedef JournalRecord<T> RecordType;
+
+        private:
+            const std::string prefix_;
+
+            size_t bytes_read_ = 0;
+            uint64_t last_seq_num_ = 0;
+
+        public:
+            explicit JournalReader(const std::string& prefix) : prefix_(prefix) {}
+
+            /// Calls func(seq_num, record) for every record in order, stops at the first sequence gap.
+            /// A record that fails its checksum ends its segment. Replay carries on into the next segment only if that
+            /// continues the sequence, as it does after a restart where findJournalEnd() skipped the torn record.
+            /// Returns the number of records replayed.
+            template<typename F>
+            auto replay(F&& func) -> size_t {
+                size_t num_records = 0;
+
+                for(size_t segment_idx = 0; ; segment_idx++){
+                    auto segment = openJournalSegment(prefix_, segment_idx, sizeof(RecordType));
+                    if(!segment)
+                        break;
+
+                    auto offset = sizeof(JournalSegmentHeader);
+                    for(; offset + sizeof(RecordType) <= segment->size_; offset += sizeof(RecordType)){
+                        const auto journal_record = reinterpret_cast<const RecordType*>(segment->data_ + offset);
+
+                        if(!journal_record->seq_num_)
+                            break;
+
+                        if(journal_record->checksum_ != journalRecordChecksum(journal_record->seq_num_, reinterpret_cast<const char*>(journal_record), sizeof(RecordType))) [[unlikely]] {
+                            std::cerr << "JournalReader " << prefix_ << " checksum mismatch in segment " << segment_idx << " seq_num:" << journal_record->seq_num_ << std::endl;
+                            break;
+                        }
+
+                        if(last_seq_num_ && journal_record->seq_num_ != last_seq_num_ + 1) [[unlikely]] {
+                            std::cerr << "JournalReader " << prefix_ << " gap in segment " << segment_idx << " expected seq_num:" << last_seq_num_ + 1 << " found:" << journal_record->seq_num_ << std::endl;
+                            closeJournalSegment(segment);
+                            return num_records;
+                        }
+
+                        func(journal_record->seq_num_, journal_record->record_);
+                        last_seq_num_ = journal_record->seq_num_;
+                        num_records++;
+                    }
+
+                    bytes_read_ += offset;
+                    closeJournalSegment(segment);
+                }
+
+                return num_records;
+            }
+
+            auto getBytesRead() const noexcept {
+                return bytes_read_;
+            }
+
+            auto getLastSeqNum() const noexcept {
+                return last_seq_num_;
+            }
+
+            JournalReader() = delete;
+            JournalReader(const JournalReader &) = delete;
+            JournalReader(const JournalReader &&) = delete;
+            JournalReader& operator=(const JournalReader &) = delete;
+            JournalReader& operator=(const JournalReader &&) = delete;
+    };
+}
@@ -1,5 +1,7 @@
 #pragma once
+#include <array>
 #include <fstream>
+#include <vector>
 
 #include "macros.hpp"
 #include "thread_utils.hpp"
@@ -9,6 +11,26 @@
 namespace Common {
     constexpr size_t LOG_QUEUE_SIZE = 1024 * 1024;
 
+    /// Per thread queue size and the most threads that may log to one MultiProducerLogger at the same time.
+    constexpr size_t LOG_PRODUCER_QUEUE_SIZE = 256 * 1024;
+    constexpr size_t LOG_MAX_PRODUCERS = 64;
+
+    enum class LoggerMode : int8_t {
+        SINGLE_PRODUCER = 0,
+        MULTI_PRODUCER = 1
+    };
+
+    inline auto loggerModeToString(LoggerMode mode) -> std::string {
+        switch(mode){
+            case LoggerMode::SINGLE_PRODUCER:
+                return "SINGLE_PRODUCER";
+            case LoggerMode::MULTI_PRODUCER:
+                return "MULTI_PRODUCER";
+        }
+
+        return "UNKNOWN";
+    }
+
     enum class LogType : int8_t {
         CHAR = 0,
         INTEGER = 1,
@@ -18,7 +40,10 @@ namespace Common {
         UNSIGNED_LONG_INTEGER = 5,
         UNSIGNED_LONG_LONG_INTEGER = 6,
         FLOAT = 7,
-        DOUBLE = 8
+        DOUBLE = 8,
+        // Frame one log() call in MULTI_PRODUCER mode, RECORD_START carries the rdtsc() of the call in u_.ull.
+        RECORD_START = 9,
+        RECORD_END = 10
     };
 
     struct LogElement {
@@ -37,146 +62,271 @@ namespace Common {
         } u_;
     };
 
-    class Logger final {
-        
+    /// Asynchronous logger, log() formats into a lock free queue that a background thread writes to the file.
+    /// SINGLE_PRODUCER (Logger): one queue, only one thread may log.
+    /// MULTI_PRODUCER (MultiProducerLogger): every logging thread registers its own SPSC queue on its first call,
+    /// without locks, and releases it when it exits for the next thread that registers. The background thread merges the records of all queues by the rdtsc() taken at the start of
+    /// each log() call, so the file is in time order except for records still being published while it merges.
+    /// The mode is a template parameter so that the single producer log() stays a plain push to its queue.
+    template<LoggerMode Mode>
+    class BasicLogger final {
         private:
+            enum class ProducerState : int8_t {
+                OWNED = 0,
+                RELEASED = 1,
+                ORPHANED = 2
+            };
+
+            /// One logging thread's queue in MULTI_PRODUCER mode.
+            struct ProducerQueue {
+                // OWNED by a live thread. RELEASED once that thread exited, the next thread to register takes it over,
+                // which keeps the queue single producer as ownership passes through state_. ORPHANED once the Logger is
+                // gone while the thread still lives, the thread deletes it on exit.
+                std::atomic<ProducerState> state_{ProducerState::OWNED};
+                LFQueue<LogElement> queue_;
+
+                // Bumped by the owner after each RECORD_END, counts the records in queue_ that are complete.
+                std::atomic<uint64_t> records_published_{0};
+                // Logger thread only.
+                uint64_t records_written_ = 0;
+
+                ProducerQueue() : queue_(LOG_PRODUCER_QUEUE_SIZE) {}
+            };
+
+            /// The producer queues a thread owns over all Loggers, released from its destructor at thread exit.
+            struct ThreadProducers {
+                struct Entry {
+                    uint64_t logger_id_;
+                    ProducerQueue* producer_;
+                };
+                std::vector<Entry> entries_;
+
+                ~ThreadProducers() {
+                    cache_ = {};
+                    for(const auto& entry : entries_){
+                        if(entry.producer_->state_.exchange(ProducerState::RELEASED, std::memory_order_acq_rel) == ProducerState::ORPHANED)
+                            delete entry.producer_;
+                    }
+                }
+            };
+
+            struct CacheEntry {
+                uint64_t logger_id_ = UINT64_MAX;
+                ProducerQueue* producer_ = nullptr;
+            };
+
+            /// The calling thread's last used queue. Kept apart from ThreadProducers so that log() reads a trivially
+            /// destructible thread_local, which needs no init guard.
+            static inline thread_local CacheEntry cache_;
+
             const std::string fileName;
+            const uint64_t id_;
             std::ofstream fout;
             LFQueue<LogElement> queue_;
             std::thread* logger_thread_ = nullptr;
 
+            // Slots are claimed with fetch_add and published with a release store, the logger thread skips
+            // a claimed slot until its queue is published.
+            std::array<std::atomic<ProducerQueue*>, LOG_MAX_PRODUCERS> producer_queues_{};
+            std::atomic<size_t> num_producers_{0};
+
             std::atomic<bool> running_{true};
-        
-        public:
 
-            auto flushQueue() noexcept {
-                while(running_){
-                    for(auto next = queue_.getNextReadLocation(); queue_.size() && next; next = queue_.getNextReadLocation()){
-                        switch(next->type_){
-                            case LogType::CHAR:
-                                fout << next->u_.c;
-                                break;
-                            case LogType::DOUBLE:
-                                fout << next->u_.d;
-                                break;
-                            case LogType::FLOAT:
-                                fout << next->u_.f;
-                                break;
-                            case LogType::INTEGER:
-                                fout << next->u_.i;
-                                break;
-                            case LogType::LONG_INTEGER:
-                                fout << next->u_.l;
-                                break;
-                            case LogType::LONG_LONG_INTEGER:
-                                fout << next->u_.ll;
-                                break;
-                            case LogType::UNSIGNED_INTEGER:
-                                fout << next->u_.u;
-                                break;
-                            case LogType::UNSIGNED_LONG_INTEGER:
-                                fout << next->u_.ul;
-                                break;
-                            case LogType::UNSIGNED_LONG_LONG_INTEGER:
-                                fout << next->u_.ull;
-                                break;
-                        }
-                        queue_.updateNextToRead();
-                    }
-                    fout.flush();
+            /// Distinguishes Logger instances in the per thread cache, addresses can be reused.
+            static inline std::atomic<uint64_t> next_id_{0};
 
-                    {
-                        using namespace std::literals::chrono_literals;
-                        std::this_thread::sleep_for(10ms);
-                    }
+            /// Takes over a queue released by an exited thread, or claims a new slot.
+            auto claimProducer() noexcept -> ProducerQueue* {
+                for(size_t i = 0; i < getNumProducers(); i++){
+                    const auto producer = producer_queues_[i].load(std::memory_order_acquire);
+                    auto expected = ProducerState::RELEASED;
+                    if(producer && producer->state_.compare_exchange_strong(expected, ProducerState::OWNED, std::memory_order_acq_rel))
+                        return producer;
                 }
+
+                const auto idx = num_producers_.fetch_add(1);
+                ASSERT(idx < LOG_MAX_PRODUCERS, "Too many threads logging to " + fileName + ", max:" + std::to_string(LOG_MAX_PRODUCERS));
+
+                const auto producer = new ProducerQueue();
+                producer_queues_[idx].store(producer, std::memory_order_release);
+                return producer;
             }
 
-            explicit Logger(const std::string& fname) : fileName(fname), queue_(LFQueue<LogElement>(LOG_QUEUE_SIZE)){
-                fout.open(fileName);
-                ASSERT(fout.is_open(), "Coud not open log file: " + fileName);
-                logger_thread_ = setAndCreateThread(-1, "Common/Logger " + fileName, [this](){this->flushQueue();});
-                ASSERT(logger_thread_ != nullptr, "Failed to start logger thread for " + fileName);
+            auto registerProducer() noexcept -> ProducerQueue* {
+                static thread_local ThreadProducers thread_producers;
+
+                // A thread logging to several Loggers only misses the cache when it switches between them.
+                for(const auto& entry : thread_producers.entries_){
+                    if(entry.logger_id_ == id_)
+                        return entry.producer_;
+                }
+
+                const auto producer = claimProducer();
+                thread_producers.entries_.push_back({id_, producer});
+                return producer;
             }
 
-            ~Logger(){
-                std::string time_str;
-                std::cerr << Common::getCurrentTimeStr(&time_str) << "Flushing and closing Logger for " << fileName << std::endl;
+            /// The calling thread's producer queue in MULTI_PRODUCER mode.
+            auto producer() noexcept -> ProducerQueue* {
+                if(cache_.logger_id_ != id_) [[unlikely]]
+                    cache_ = {id_, registerProducer()};
+                return cache_.producer_;
+            }
 
-                while(queue_.size()){
-                    using namespace std::literals::chrono_literals;
-                    std::this_thread::sleep_for(1s);
+            auto writeElement(const LogElement& log_elem) noexcept {
+                switch(log_elem.type_){
+                    case LogType::CHAR:
+                        fout << log_elem.u_.c;
+                        break;
+                    case LogType::DOUBLE:
+                        fout << log_elem.u_.d;
+                        break;
+                    case LogType::FLOAT:
+                        fout << log_elem.u_.f;
+                        break;
+                    case LogType::INTEGER:
+                        fout << log_elem.u_.i;
+                        break;
+                    case LogType::LONG_INTEGER:
+                        fout << log_elem.u_.l;
+                        break;
+                    case LogType::LONG_LONG_INTEGER:
+                        fout << log_elem.u_.ll;
+                        break;
+                    case LogType::UNSIGNED_INTEGER:
+                        fout << log_elem.u_.u;
+                        break;
+                    case LogType::UNSIGNED_LONG_INTEGER:
+                        fout << log_elem.u_.ul;
+                        break;
+                    case LogType::UNSIGNED_LONG_LONG_INTEGER:
+                        fout << log_elem.u_.ull;
+                        break;
+                    case LogType::RECORD_START:
+                    case LogType::RECORD_END:
+                        break;
+                }
+            }
+
+            /// Writes the record at the head of producer's queue, which must be complete. Elements pushed outside log()
+            /// have no frame and are written up to the next record.
+            auto writeRecord(ProducerQueue& producer) noexcept {
+                auto& queue = producer.queue_;
+                if(queue.getNextReadLocation()->type_ != LogType::RECORD_START){
+                    for(auto next = queue.getNextReadLocation(); next && next->type_ != LogType::RECORD_START; next = queue.getNextReadLocation()){
+                        writeElement(*next);
+                        queue.updateNextToRead();
+                    }
+                    return;
+                }
+                queue.updateNextToRead();
+
+                for(auto next = queue.getNextReadLocation(); next->type_ != LogType::RECORD_END; next = queue.getNextReadLocation()){
+                    writeElement(*next);
+                    queue.updateNextToRead();
+                }
+                queue.updateNextToRead();
+                producer.records_written_++;
+            }
+
+            /// k-way merge of the producer queues until none has a complete record left. The oldest head record is
+            /// found with a linear scan, with a few dozen producers at most that beats maintaining a heap.
+            /// A record still being published is left for the next pass instead of waiting on its producer.
+            auto mergeProducerQueues() noexcept {
+                const auto num_producers = std::min(num_producers_.load(std::memory_order_acquire), LOG_MAX_PRODUCERS);
+
+                while(true){
+                    ProducerQueue* oldest = nullptr;
+                    auto oldest_tsc = UINT64_MAX;
+
+                    for(size_t i = 0; i < num_producers; i++){
+                        const auto producer = producer_queues_[i].load(std::memory_order_acquire);
+                        const auto head = producer ? producer->queue_.getNextReadLocation() : nullptr;
+                        if(!head)
+                            continue;
+
+                        const auto framed = (head->type_ == LogType::RECORD_START);
+                        if(framed && producer->records_published_.load(std::memory_order_acquire) == producer->records_written_)
+                            continue;
+
+                        const auto tsc = framed ? head->u_.ull : 0;
+                        if(tsc < oldest_tsc){
+                            oldest_tsc = tsc;
+                            oldest = producer;
+                        }
+                    }
+
+                    if(!oldest)
+                        return;
+                    writeRecord(*oldest);
                 }
-                running_ = false;
-                fout.close();
-                std::cerr << Common::getCurrentTimeStr(&time_str) << "Logger for " << fileName << " exiting." << std::endl;
             }
 
-            auto pushValue(const LogElement& log_elem) noexcept {
-                *(queue_.getNextWriteLocation()) = log_elem;
-                queue_.updateNextToWrite();
+            auto push(LFQueue<LogElement>* queue, const LogElement& log_elem) noexcept {
+                *(queue->getNextWriteLocation()) = log_elem;
+                queue->updateNextToWrite();
             }
 
-            auto pushValue(const char value) noexcept {
-                pushValue(LogElement{LogType::CHAR, {.c = value}});
+            auto push(LFQueue<LogElement>* queue, const char value) noexcept {
+                push(queue, LogElement{LogType::CHAR, {.c = value}});
             }
 
-            auto pushValue(const int value) noexcept {
-                pushValue(LogElement{LogType::INTEGER, {.i = value}});
+            auto push(LFQueue<LogElement>* queue, const int value) noexcept {
+                push(queue, LogElement{LogType::INTEGER, {.i = value}});
             }
 
-            auto pushValue(const long value) noexcept {
-                pushValue(LogElement{LogType::LONG_INTEGER, {.l = value}});
+            auto push(LFQueue<LogElement>* queue, const long value) noexcept {
+                push(queue, LogElement{LogType::LONG_INTEGER, {.l = value}});
             }
 
-            auto pushValue(const long long value) noexcept {
-                pushValue(LogElement{LogType::LONG_LONG_INTEGER, {.ll = value}});
+            auto push(LFQueue<LogElement>* queue, const long long value) noexcept {
+                push(queue, LogElement{LogType::LONG_LONG_INTEGER, {.ll = value}});
             }
 
-            auto pushValue(const unsigned value) noexcept {
-                pushValue(LogElement{LogType::UNSIGNED_INTEGER, {.u = value}});
+            auto push(LFQueue<LogElement>* queue, const unsigned value) noexcept {
+                push(queue, LogElement{LogType::UNSIGNED_INTEGER, {.u = value}});
             }
 
-            auto pushValue(const unsigned long value) noexcept {
-                pushValue(LogElement{LogType::UNSIGNED_LONG_INTEGER, {.ul = value}});
+            auto push(LFQueue<LogElement>* queue, const unsigned long value) noexcept {
+                push(queue, LogElement{LogType::UNSIGNED_LONG_INTEGER, {.ul = value}});
             }
 
-            auto pushValue(const unsigned long long value) noexcept {
-                pushValue(LogElement{LogType::UNSIGNED_LONG_LONG_INTEGER, {.ull = value}});
+            auto push(LFQueue<LogElement>* queue, const unsigned long long value) noexcept {
+                push(queue, LogElement{LogType::UNSIGNED_LONG_LONG_INTEGER, {.ull = value}});
             }
 
-            auto pushValue(const float value) noexcept {
-                pushValue(LogElement{LogType::FLOAT, {.f = value}});
+            auto push(LFQueue<LogElement>* queue, const float value) noexcept {
+                push(queue, LogElement{LogType::FLOAT, {.f = value}});
             }
 
-            auto pushValue(const double value) noexcept {
-                pushValue(LogElement{LogType::DOUBLE, {.d = value}});
+            auto push(LFQueue<LogElement>* queue, const double value) noexcept {
+                push(queue, LogElement{LogType::DOUBLE, {.d = value}});
             }
 
-            auto pushValue(const char* value) noexcept {
+            auto push(LFQueue<LogElement>* queue, const char* value) noexcept {
                 while(*value){
-                    pushValue(*value);
+                    push(queue, *value);
                     value++;
                 }
             }
 
-            auto pushValue(const std::string& value) noexcept {
-                pushValue(value.c_str());
+            auto push(LFQueue<LogElement>* queue, const std::string& value) noexcept {
+                push(queue, value.c_str());
             }
 
             template<typename T, typename... A>
-            auto log(const char* s, const T& value, A... args) noexcept {
+            auto format(LFQueue<LogElement>* queue, const char* s, const T& value, A... args) noexcept {
                 while(*s){
                     if(*s == '%'){
                         if(*(s+1) == '%') [[unlikely]] {
                             s++;
                         } else {
-                            pushValue(value);
-                            log(s+1, args...);
+                            push(queue, value);
+                            format(queue, s+1, args...);
                             return;
                         }
                     }
-                    pushValue(*s++);
+                    push(queue, *s++);
                 }
                 
                 /* 
@@ -187,7 +337,7 @@ namespace Common {
                 FATAL("Extra arguments given to log() function.");
             }
 
-            auto log(const char* s) noexcept {
+            auto format(LFQueue<LogElement>* queue, const char* s) noexcept {
                 while(*s) {
                     if(*s == '%') {
                         if(*(s+1) == '%') [[unlikely]] {
@@ -196,12 +346,134 @@ namespace Common {
                             FATAL("Fewer arguments given to log() function.");
                         }
                     }
-                    pushValue(*s++);
+                    push(queue, *s++);
                 }
             }
 
+        public:
 
-    };
+            auto flushQueue() noexcept {
+                while(running_){
+                    if constexpr(Mode == LoggerMode::MULTI_PRODUCER){
+                        mergeProducerQueues();
+                    } else {
+                        for(auto next = queue_.getNextReadLocation(); queue_.size() && next; next = queue_.getNextReadLocation()){
+                            writeElement(*next);
+                            queue_.updateNextToRead();
+                        }
+                    }
+                    fout.flush();
+
+                    {
+                        using namespace std::literals::chrono_literals;
+                        std::this_thread::sleep_for(10ms);
+                    }
+                }
+            }
+
+            /// MULTI_PRODUCER does not use the single queue and keeps it minimal.
+            explicit BasicLogger(const std::string& fname)
+                : fileName(fname), id_(next_id_++), queue_(LFQueue<LogElement>(Mode == LoggerMode::SINGLE_PRODUCER ? LOG_QUEUE_SIZE : 1)){
+                fout.open(fileName);
+                ASSERT(fout.is_open(), "Coud not open log file: " + fileName);
+                logger_thread_ = setAndCreateThread(-1, "Common/Logger " + fileName, [this](){this->flushQueue();});
+                ASSERT(logger_thread_ != nullptr, "Failed to start logger thread for " + fileName);
+            }
 
+            ~BasicLogger(){
+                std::string time_str;
+                std::cerr << Common::getCurrentTimeStr(&time_str) << "Flushing and closing Logger for " << fileName << std::endl;
+
+                // A producer that stopped between RECORD_START and RECORD_END leaves a record that is never written,
+                // so stop waiting once a second passes without progress.
+                auto pending = pendingSize();
+                for(auto last_pending = SIZE_MAX; pending && pending < last_pending; pending = pendingSize()){
+                    last_pending = pending;
+                    using namespace std::literals::chrono_literals;
+                    std::this_thread::sleep_for(1s);
+                }
+                if(pending)
+                    std::cerr << Common::getCurrentTimeStr(&time_str) << "Dropping " << pending << " pending log elements for " << fileName << std::endl;
+
+                running_ = false;
+                logger_thread_->join();
+                delete logger_thread_;
+                fout.close();
+
+                // Queues of threads still running are left to them, see ProducerQueue::state_.
+                for(auto& slot : producer_queues_){
+                    const auto producer = slot.load();
+                    if(producer && producer->state_.exchange(ProducerState::ORPHANED, std::memory_order_acq_rel) == ProducerState::RELEASED)
+                        delete producer;
+                }
+
+                std::cerr << Common::getCurrentTimeStr(&time_str) << "Logger for " << fileName << " exiting." << std::endl;
+            }
+
+            auto getMode() const noexcept {
+                return Mode;
+            }
+
+            /// Number of producer queues registered so far, 0 in SINGLE_PRODUCER mode.
+            auto getNumProducers() const noexcept -> size_t {
+                return std::min(num_producers_.load(std::memory_order_acquire), LOG_MAX_PRODUCERS);
+            }
+
+            /// The producer queues registered so far, have each logging thread log once before declaring.
+            /// The logger thread runs from construction on, so the queues are declared concurrent: locked but not
+            /// pre-faulted, they are faulted in when the queue is built.
+            /// W is WarmUp, see LFQueue::declareHotMemory().
+            template<typename W = WarmUp>
+            auto declareHotMemory(W& warm_up, const std::string& name) noexcept -> void {
+                queue_.declareHotMemory(warm_up, name, true);
+                for(size_t i = 0; i < getNumProducers(); i++){
+                    if(const auto producer = producer_queues_[i].load(std::memory_order_acquire))
+                        producer->queue_.declareHotMemory(warm_up, name + " producer " + std::to_string(i), true);
+                }
+            }
+
+            /// Number of elements still waiting to be written by the logger thread, over all producer queues.
+            auto pendingSize() const noexcept -> size_t {
+                auto pending = queue_.size();
+                for(size_t i = 0; i < getNumProducers(); i++){
+                    if(const auto producer = producer_queues_[i].load(std::memory_order_acquire))
+                        pending += producer->queue_.size();
+                }
+                return pending;
+            }
+
+            /// Pushes one unframed value to the calling thread's queue.
+            template<typename T>
+            auto pushValue(const T& value) noexcept {
+                if constexpr(Mode == LoggerMode::MULTI_PRODUCER)
+                    push(&producer()->queue_, value);
+                else
+                    push(&queue_, value);
+            }
+
+            /// Formats s with each % replaced by the next argument, %% is a literal %.
+            template<typename... A>
+            auto log(const char* s, const A&... args) noexcept {
+                if constexpr(Mode == LoggerMode::MULTI_PRODUCER){
+                    const auto producer = this->producer();
+                    const auto queue = &producer->queue_;
+                    push(queue, LogElement{LogType::RECORD_START, {.ull = rdtsc()}});
+                    format(queue, s, args...);
+                    push(queue, LogElement{LogType::RECORD_END, {}});
+                    // Only the owner writes the counter, no read-modify-write needed.
+                    producer->records_published_.store(producer->records_published_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                } else {
+                    format(&queue_, s, args...);
+                }
+            }
+
+            BasicLogger() = delete;
+            BasicLogger(const BasicLogger&) = delete;
+            BasicLogger(const BasicLogger&&) = delete;
+            BasicLogger& operator=(const BasicLogger&) = delete;
+            BasicLogger& operator=(const BasicLogger&&) = delete;
+    };
 
+    typedef BasicLogger<LoggerMode::SINGLE_PRODUCER> Logger;
+    typedef BasicLogger<LoggerMode::MULTI_PRODUCER> MultiProducerLogger;
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "market_data_recovery.hpp"
+
+namespace Common {
+    MarketDataRecovery::MarketDataRecovery(MEMarketUpdateLFQueue* outgoing_updates, Logger& logger, size_t max_queued_msgs)
+        : outgoing_updates_(outgoing_updates), logger_(logger) {
+        snapshot_queued_msgs_.reserve(max_queued_msgs);
+        incremental_queued_msgs_.reserve(max_queued_msgs);
+    }
+
+    auto MarketDataRecovery::forward(const MEMarketUpdate& me_market_update) noexcept -> void {
+        *(outgoing_updates_->getNextWriteLocation()) = me_market_update;
+        outgoing_updates_->updateNextToWrite();
+    }
+
+    auto MarketDataRecovery::startRecovery() noexcept -> void {
+        logger_.log("%:% %() % Starting recovery next_exp_inc_seq_num:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), next_exp_inc_seq_num_);
+
+        in_recovery_ = true;
+        snapshot_queued_msgs_.clear();
+        incremental_queued_msgs_.clear();
+    }
+
+    auto MarketDataRecovery::onIncremental(const MDPMarketUpdate& market_update) noexcept -> void {
+        if(!in_recovery_) [[likely]] {
+            if(market_update.seq_num_ == next_exp_inc_seq_num_) [[likely]] {
+                forward(market_update.me_market_update_);
+                next_exp_inc_seq_num_++;
+                return;
+            }
+
+            // Duplicate / stale incremental.
+            if(market_update.seq_num_ < next_exp_inc_seq_num_)
+                return;
+
+            startRecovery();
+        }
+
+        // Buffer is full, everything queued so far has to come from a later snapshot anyway.
+        if(incremental_queued_msgs_.size() == incremental_queued_msgs_.capacity()) [[unlikely]] {
+            logger_.log("%:% %() % Incremental queue full, dropping % queued incrementals.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), incremental_queued_msgs_.size());
+            incremental_queued_msgs_.clear();
+        }
+
+        incremental_queued_msgs_.push_back(market_update);
+
+        checkSnapshotSync();
+    }
+
+    auto MarketDataRecovery::onSnapshot(const MDPMarketUpdate& market_update) noexcept -> void {
+        if(!in_recovery_) [[likely]]
+            return;
+
+        if(market_update.me_market_update_.type_ == MarketUpdateType::SNAPSHOT_START){
+            snapshot_queued_msgs_.clear();
+        } else if(snapshot_queued_msgs_.empty()){
+            // Joined in the middle of a snapshot, wait for the next one.
+            return;
+        }
+
+        if(market_update.seq_num_ != snapshot_queued_msgs_.size() || snapshot_queued_msgs_.size() == snapshot_queued_msgs_.capacity()) [[unlikely]] {
+            logger_.log("%:% %() % Dropping snapshot, expected seq:% received:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), snapshot_queued_msgs_.size(), market_update.seq_num_);
+            snapshot_queued_msgs_.clear();
+            return;
+        }
+
+        snapshot_queued_msgs_.push_back(market_update);
+
+        if(market_update.me_market_update_.type_ == MarketUpdateType::SNAPSHOT_END)
+            checkSnapshotSync();
+    }
+
+    auto MarketDataRecovery::checkSnapshotSync() noexcept -> void {
+        if(snapshot_queued_msgs_.empty() || snapshot_queued_msgs_.back().me_market_update_.type_ != MarketUpdateType::SNAPSHOT_END)
+            return;
+
+        const auto last_snapshot_inc_seq_num = snapshot_queued_msgs_.front().me_market_update_.order_id_;
+
+        auto next_exp_seq_num = last_snapshot_inc_seq_num + 1;
+        for(const auto& inc : incremental_queued_msgs_){
+            if(inc.seq_num_ <= last_snapshot_inc_seq_num)
+                continue;
+
+            if(inc.seq_num_ != next_exp_seq_num){
+                logger_.log("%:% %() % Gap in incrementals after snapshot, expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), next_exp_seq_num, inc.seq_num_);
+                snapshot_queued_msgs_.clear();
+                return;
+            }
+
+            next_exp_seq_num++;
+        }
+
+        for(const auto& snapshot : snapshot_queued_msgs_){
+            const auto type = snapshot.me_market_update_.type_;
+            if(type != MarketUpdateType::SNAPSHOT_START && type != MarketUpdateType::SNAPSHOT_END)
+                forward(snapshot.me_market_update_);
+        }
+
+        for(const auto& inc : incremental_queued_msgs_){
+            if(inc.seq_num_ > last_snapshot_inc_seq_num)
+                forward(inc.me_market_update_);
+        }
+
+        logger_.log("%:% %() % Recovered from snapshot last_inc_seq_num:% snapshot_msgs:% replayed up to:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), last_snapshot_inc_seq_num, snapshot_queued_msgs_.size(), next_exp_seq_num - 1);
+
+        next_exp_inc_seq_num_ = next_exp_seq_num;
+        in_recovery_ = false;
+        snapshot_queued_msgs_.clear();
+        incremental_queued_msgs_.clear();
+    }
+}
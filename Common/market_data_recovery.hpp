@@ -0,0 +1,51 @@
+#pragma once
+
+#include "logging.hpp"
+#include "market_update.hpp"
+
+namespace Common {
+    /// Client side gap recovery for the incremental market data stream.
+    /// In steady state incrementals are forwarded as they arrive. On a sequence gap incrementals are buffered
+    /// until a complete snapshot arrives, the snapshot is applied and the buffered incrementals after it are replayed.
+    class MarketDataRecovery {
+        private:
+            MEMarketUpdateLFQueue* outgoing_updates_ = nullptr;
+
+            Logger& logger_;
+            std::string time_str_;
+
+            size_t next_exp_inc_seq_num_ = 1;
+            bool in_recovery_ = false;
+
+            // Preallocated so that recovery does not allocate.
+            std::vector<MDPMarketUpdate> snapshot_queued_msgs_;
+            std::vector<MDPMarketUpdate> incremental_queued_msgs_;
+
+            auto forward(const MEMarketUpdate& me_market_update) noexcept -> void;
+
+            auto startRecovery() noexcept -> void;
+
+            auto checkSnapshotSync() noexcept -> void;
+
+        public:
+            MarketDataRecovery(MEMarketUpdateLFQueue* outgoing_updates, Logger& logger, size_t max_queued_msgs = ME_MAX_ORDER_IDS);
+
+            auto onIncremental(const MDPMarketUpdate& market_update) noexcept -> void;
+
+            auto onSnapshot(const MDPMarketUpdate& market_update) noexcept -> void;
+
+            auto inRecovery() const noexcept {
+                return in_recovery_;
+            }
+
+            auto getNextExpIncSeqNum() const noexcept {
+                return next_exp_inc_seq_num_;
+            }
+
+            MarketDataRecovery() = delete;
+            MarketDataRecovery(const MarketDataRecovery&) = delete;
+            MarketDataRecovery(const MarketDataRecovery&&) = delete;
+            MarketDataRecovery& operator=(const MarketDataRecovery&) = delete;
+            MarketDataRecovery& operator=(const MarketDataRecovery&&) = delete;
+    };
+}
@@ -6,53 +6,64 @@
 #include "macros.hpp"
 
 namespace Common {
+    class WarmUp;
+
+    /// Fixed pool of num_elem T's. Free blocks are chained through the blocks themselves, allocate() and
+    /// deallocate() are O(1) however full the pool is and hand out the most recently freed block first.
     template<typename T>
     class Mempool{
         private:
             struct ObjBlock{
                 T obj_;
                 bool is_free_ = true;
+                ObjBlock* next_free_ = nullptr;
             };
 
             std::vector<ObjBlock> obj_store_;
 
-            size_t next_free_idx_ = 0;
-
-            void updateNextFreeBlock(){
-                const auto curr_idx = next_free_idx_;
-
-                while(!obj_store_[next_free_idx_].is_free_){
-                    next_free_idx_++;
-                    if(next_free_idx_ == obj_store_.size()) [[unlikely]]
-                        next_free_idx_ = 0;
-                    if(next_free_idx_ == curr_idx) [[unlikely]]
-                        FATAL("Memory pool out of memory");
-                }
-            }
+            ObjBlock* free_head_ = nullptr;
 
         public:
             Mempool(size_t num_elem) : obj_store_(std::vector<ObjBlock>(num_elem, ObjBlock({T(), true}))) {
                 ASSERT(reinterpret_cast<const ObjBlock*>(&(obj_store_[0].obj_)) == &(obj_store_[0]), "T object should be the first member of ObjBlock.");
+
+                for(size_t i = num_elem; i > 0; i--){
+                    obj_store_[i - 1].next_free_ = free_head_;
+                    free_head_ = &obj_store_[i - 1];
+                }
             }
             
             template<typename... Args>
             T* allocate(Args&&... args) noexcept{
-                auto obj_block_ = &(obj_store_[next_free_idx_]);
-                ASSERT(obj_block_->is_free_, "Expected a free block at : " + std::to_string(next_free_idx_));
+                auto obj_block_ = free_head_;
+                // Not ASSERT(), its message would be built on every call.
+                if(!obj_block_) [[unlikely]]
+                    FATAL("Memory pool out of memory");
+                free_head_ = obj_block_->next_free_;
+
                 T* ret = &(obj_block_->obj_);
                 ret = new(ret) T((std::forward<Args>(args))...);
                 obj_block_->is_free_ = false;
-                updateNextFreeBlock();
                 return ret;
             }
 
             void deallocate(const T* elem) noexcept {
                 const auto idx = reinterpret_cast<const ObjBlock*>(elem) - &obj_store_[0];
 
-                ASSERT(idx >= 0 && static_cast<size_t>(idx) < obj_store_.size(), "Element does not belong to this pool");
-                ASSERT(!obj_store_[idx].is_free_, "Expected to be an allocated block");
+                if(idx < 0 || static_cast<size_t>(idx) >= obj_store_.size()) [[unlikely]]
+                    FATAL("Element does not belong to this pool");
+                if(obj_store_[idx].is_free_) [[unlikely]]
+                    FATAL("Expected to be an allocated block");
 
                 obj_store_[idx].is_free_ = true;
+                obj_store_[idx].next_free_ = free_head_;
+                free_head_ = &obj_store_[idx];
+            }
+
+            /// W is WarmUp, a template parameter so that this header gets by with its declaration.
+            template<typename W = WarmUp>
+            void declareHotMemory(W& warm_up, const std::string& name) noexcept {
+                warm_up.declareHotMemory(name, obj_store_.data(), obj_store_.size() * sizeof(ObjBlock));
             }
 
             Mempool() = delete;
@@ -0,0 +1,205 @@
+#include <immintrin.h>
+
+#include "risk_engine.hpp"
+#include "warm_up.hpp"
+
+namespace Common {
+    namespace {
+        constexpr int64_t ORDER_FIELDS_BIT = riskRejectBit(RiskCheck::ORDER_FIELDS);
+        constexpr int64_t ORDER_QTY_BIT = riskRejectBit(RiskCheck::ORDER_QTY);
+        constexpr int64_t NOTIONAL_BIT = riskRejectBit(RiskCheck::NOTIONAL);
+        constexpr int64_t POSITION_BIT = riskRejectBit(RiskCheck::POSITION);
+        constexpr int64_t PRICE_COLLAR_BIT = riskRejectBit(RiskCheck::PRICE_COLLAR);
+        constexpr int64_t MESSAGE_RATE_BIT = riskRejectBit(RiskCheck::MESSAGE_RATE);
+
+        inline auto statelessRejects(int64_t valid, int64_t qty, int64_t price, int64_t max_order_qty, int64_t max_order_notional,
+                                     int64_t reference_price, int64_t max_price_deviation) noexcept -> int64_t {
+            const auto deviation = price - reference_price;
+            return (!valid * ORDER_FIELDS_BIT) |
+                   ((qty > max_order_qty) * ORDER_QTY_BIT) |
+                   ((price * qty > max_order_notional) * NOTIONAL_BIT) |
+                   (((deviation < 0 ? -deviation : deviation) > max_price_deviation) * PRICE_COLLAR_BIT);
+        }
+
+        /// The stateless checks four orders at a time. AVX2 has no 64 bit multiply, price * qty is built from
+        /// two 32x32 bit products, qty fits in 32 bits and staged prices are not negative.
+        __attribute__((target("avx2")))
+        auto statelessRejectsAvx2(const int64_t* valid, const int64_t* qty, const int64_t* price, const int64_t* max_order_qty,
+                                  const int64_t* max_order_notional, const int64_t* reference_price, const int64_t* max_price_deviation,
+                                  int64_t* rejects, size_t n) noexcept -> size_t {
+            const auto zero = _mm256_setzero_si256();
+            const auto order_fields_bit = _mm256_set1_epi64x(ORDER_FIELDS_BIT);
+            const auto order_qty_bit = _mm256_set1_epi64x(ORDER_QTY_BIT);
+            const auto notional_bit = _mm256_set1_epi64x(NOTIONAL_BIT);
+            const auto price_collar_bit = _mm256_set1_epi64x(PRICE_COLLAR_BIT);
+
+            size_t i = 0;
+            for(; i + 4 <= n; i += 4){
+                const auto v_valid = _mm256_load_si256(reinterpret_cast<const __m256i*>(valid + i));
+                const auto v_qty = _mm256_load_si256(reinterpret_cast<const __m256i*>(qty + i));
+                const auto v_price = _mm256_load_si256(reinterpret_cast<const __m256i*>(price + i));
+
+                const auto invalid = _mm256_cmpeq_epi64(v_valid, zero);
+                const auto qty_breach = _mm256_cmpgt_epi64(v_qty, _mm256_load_si256(reinterpret_cast<const __m256i*>(max_order_qty + i)));
+
+                const auto notional_lo = _mm256_mul_epu32(v_price, v_qty);
+                const auto notional_hi = _mm256_mul_epu32(_mm256_srli_epi64(v_price, 32), v_qty);
+                const auto notional = _mm256_add_epi64(notional_lo, _mm256_slli_epi64(notional_hi, 32));
+                const auto notional_breach = _mm256_cmpgt_epi64(notional, _mm256_load_si256(reinterpret_cast<const __m256i*>(max_order_notional + i)));
+
+                const auto deviation = _mm256_sub_epi64(v_price, _mm256_load_si256(reinterpret_cast<const __m256i*>(reference_price + i)));
+                const auto abs_deviation = _mm256_blendv_epi8(deviation, _mm256_sub_epi64(zero, deviation), _mm256_cmpgt_epi64(zero, deviation));
+                const auto collar_breach = _mm256_cmpgt_epi64(abs_deviation, _mm256_load_si256(reinterpret_cast<const __m256i*>(max_price_deviation + i)));
+
+                const auto result = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(invalid, order_fields_bit), _mm256_and_si256(qty_breach, order_qty_bit)),
+                                                    _mm256_or_si256(_mm256_and_si256(notional_breach, notional_bit), _mm256_and_si256(collar_breach, price_collar_bit)));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(rejects + i), result);
+            }
+
+            return i;
+        }
+    }
+
+    RiskEngine::RiskEngine(size_t max_accounts, Nanos rate_window, bool use_avx2)
+        : max_accounts_(max_accounts), rate_window_(rate_window), use_avx2_(use_avx2),
+          max_order_qty_(max_accounts + 1), max_order_notional_(max_accounts + 1), max_msgs_per_window_(max_accounts + 1),
+          msg_count_(max_accounts + 1), msg_window_(max_accounts + 1),
+          max_position_((max_accounts + 1) * (ME_MAX_TICKERS + 1)), position_((max_accounts + 1) * (ME_MAX_TICKERS + 1)),
+          open_buy_qty_((max_accounts + 1) * (ME_MAX_TICKERS + 1)), open_sell_qty_((max_accounts + 1) * (ME_MAX_TICKERS + 1)) {
+        ASSERT(rate_window_ > 0, "RiskEngine rate window must be positive.");
+        ASSERT(!use_avx2_ || __builtin_cpu_supports("avx2"), "RiskEngine AVX2 checks are not supported on this CPU.");
+    }
+
+    auto RiskEngine::setAccountLimits(ClientId client_id, const RiskAccountLimits& limits) noexcept -> void {
+        ASSERT(client_id < max_accounts_, "RiskEngine account out of range:" + clientIdToString(client_id));
+
+        max_order_qty_[client_id] = limits.max_order_qty_;
+        max_order_notional_[client_id] = limits.max_order_notional_;
+        max_msgs_per_window_[client_id] = limits.max_msgs_per_window_;
+    }
+
+    auto RiskEngine::setPositionLimit(ClientId client_id, TickerId ticker_id, int64_t max_position) noexcept -> void {
+        ASSERT(client_id < max_accounts_ && ticker_id < ME_MAX_TICKERS, "RiskEngine position out of range client:" + clientIdToString(client_id) +
+               " ticker:" + tickerIdToString(ticker_id));
+
+        max_position_[positionIdx(client_id, ticker_id)] = max_position;
+    }
+
+    auto RiskEngine::setPriceCollar(TickerId ticker_id, Price reference_price, Price max_deviation) noexcept -> void {
+        ASSERT(ticker_id < ME_MAX_TICKERS, "RiskEngine ticker out of range:" + tickerIdToString(ticker_id));
+
+        reference_price_[ticker_id] = reference_price;
+        max_price_deviation_[ticker_id] = max_deviation;
+    }
+
+    /// Copies each order's fields and limits into batch_, invalid ids are pointed at the spare entries.
+    /// The exposures checkStateful() reads are prefetched here, so their cache misses overlap across the burst.
+    auto RiskEngine::stage(const RiskOrder* orders, size_t n) noexcept -> void {
+        for(size_t i = 0; i < n; i++){
+            const auto& order = orders[i];
+
+            const auto valid_account = order.client_id_ < max_accounts_;
+            const auto valid_ticker = order.ticker_id_ < ME_MAX_TICKERS;
+            const auto valid = valid_account & valid_ticker & ((order.side_ == Side::BUY) | (order.side_ == Side::SELL)) &
+                               (order.qty_ > 0) & (order.qty_ != Qty_INVALID) & (order.price_ > 0) & (order.price_ != Price_INVALID);
+
+            const auto account = valid_account ? order.client_id_ : max_accounts_;
+            const auto ticker = valid_ticker ? order.ticker_id_ : ME_MAX_TICKERS;
+
+            batch_.valid_[i] = valid;
+            batch_.qty_[i] = valid ? order.qty_ : 0;
+            batch_.price_[i] = valid ? order.price_ : 0;
+            batch_.max_order_qty_[i] = max_order_qty_[account];
+            batch_.max_order_notional_[i] = max_order_notional_[account];
+            batch_.reference_price_[i] = reference_price_[ticker];
+            batch_.max_price_deviation_[i] = max_price_deviation_[ticker];
+            batch_.account_[i] = account;
+            batch_.position_idx_[i] = positionIdx(valid_ticker ? account : max_accounts_, ticker);
+
+            const auto idx = batch_.position_idx_[i];
+            __builtin_prefetch(&max_msgs_per_window_[account]);
+            __builtin_prefetch(&msg_count_[account], 1);
+            __builtin_prefetch(&msg_window_[account], 1);
+            __builtin_prefetch(&max_position_[idx]);
+            __builtin_prefetch(&position_[idx]);
+            __builtin_prefetch(&open_buy_qty_[idx], 1);
+            __builtin_prefetch(&open_sell_qty_[idx], 1);
+        }
+    }
+
+    auto RiskEngine::checkStateless(size_t n) noexcept -> void {
+        size_t i = 0;
+        if(use_avx2_)
+            i = statelessRejectsAvx2(batch_.valid_.data(), batch_.qty_.data(), batch_.price_.data(), batch_.max_order_qty_.data(),
+                                     batch_.max_order_notional_.data(), batch_.reference_price_.data(), batch_.max_price_deviation_.data(),
+                                     batch_.rejects_.data(), n);
+
+        for(; i < n; i++)
+            batch_.rejects_[i] = statelessRejects(batch_.valid_[i], batch_.qty_[i], batch_.price_[i], batch_.max_order_qty_[i],
+                                                  batch_.max_order_notional_[i], batch_.reference_price_[i], batch_.max_price_deviation_[i]);
+    }
+
+    /// Message rate and worst case position, in order since each order sees the ones before it.
+    auto RiskEngine::checkStateful(const RiskOrder* orders, size_t n, Nanos now, RiskRejects* rejects) noexcept -> void {
+        const auto window = now / rate_window_;
+
+        for(size_t i = 0; i < n; i++){
+            const auto account = batch_.account_[i];
+            const auto idx = batch_.position_idx_[i];
+            const auto qty = batch_.qty_[i];
+            const auto is_buy = static_cast<int64_t>(orders[i].side_ == Side::BUY);
+
+            const auto msg_count = msg_count_[account] * (msg_window_[account] == window) + 1;
+            msg_count_[account] = msg_count;
+            msg_window_[account] = window;
+
+            const auto position = position_[idx];
+            const auto worst_position = is_buy * (position + open_buy_qty_[idx] + qty) + (1 - is_buy) * (open_sell_qty_[idx] + qty - position);
+
+            const auto result = batch_.rejects_[i] |
+                                ((msg_count > max_msgs_per_window_[account]) * MESSAGE_RATE_BIT) |
+                                ((worst_position > max_position_[idx]) * POSITION_BIT);
+
+            const auto accepted_qty = qty * !result;
+            open_buy_qty_[idx] += accepted_qty * is_buy;
+            open_sell_qty_[idx] += accepted_qty * (1 - is_buy);
+
+            rejects[i] = static_cast<RiskRejects>(result);
+        }
+    }
+
+    auto RiskEngine::checkBatch(const RiskOrder* orders, size_t n, Nanos now, RiskRejects* rejects) noexcept -> void {
+        for(size_t done = 0; done < n; done += RISK_BATCH_SIZE){
+            const auto batch_size = std::min(n - done, RISK_BATCH_SIZE);
+            stage(orders + done, batch_size);
+            checkStateless(batch_size);
+            checkStateful(orders + done, batch_size, now, rejects + done);
+        }
+    }
+
+    auto RiskEngine::resetExposures() noexcept -> void {
+        for(auto exposure : {&msg_count_, &msg_window_, &position_, &open_buy_qty_, &open_sell_qty_})
+            std::fill(exposure->begin(), exposure->end(), 0);
+    }
+
+    auto RiskEngine::declareHotMemory(WarmUp& warm_up, const std::string& name) noexcept -> void {
+        for(auto [array, array_name] : {std::make_pair(&max_order_qty_, "max_order_qty"), std::make_pair(&max_order_notional_, "max_order_notional"),
+                                        std::make_pair(&max_msgs_per_window_, "max_msgs_per_window"), std::make_pair(&msg_count_, "msg_count"),
+                                        std::make_pair(&msg_window_, "msg_window"), std::make_pair(&max_position_, "max_position"),
+                                        std::make_pair(&position_, "position"), std::make_pair(&open_buy_qty_, "open_buy_qty"),
+                                        std::make_pair(&open_sell_qty_, "open_sell_qty")})
+            warm_up.declareHotMemory(name + " " + array_name, array->data(), array->size() * sizeof(int64_t));
+    }
+
+    auto RiskEngine::onExecution(const RiskExecution& execution) noexcept -> void {
+        if(execution.client_id_ >= max_accounts_ || execution.ticker_id_ >= ME_MAX_TICKERS) [[unlikely]]
+            FATAL("RiskEngine got an execution for an unknown account or ticker " + execution.toString());
+
+        const auto idx = positionIdx(execution.client_id_, execution.ticker_id_);
+        auto& open_qty = (execution.side_ == Side::BUY) ? open_buy_qty_[idx] : open_sell_qty_[idx];
+        open_qty -= execution.qty_;
+
+        if(execution.type_ == RiskExecutionType::FILLED)
+            position_[idx] += static_cast<int64_t>(execution.side_) * execution.qty_;
+    }
+}
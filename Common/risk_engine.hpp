@@ -0,0 +1,263 @@
+#pragma once
+
+#include <array>
+#include <sstream>
+#include <vector>
+
+#include "macros.hpp"
+#include "types.hpp"
+#include "time_utils.hpp"
+#include "spsc_lf_queue.hpp"
+
+namespace Common {
+    class WarmUp;
+
+    constexpr size_t RISK_MAX_ACCOUNTS = 16 * 1024;
+
+    /// Most orders checked together by drain(), the SIMD checks run over the whole burst.
+    constexpr size_t RISK_BATCH_SIZE = 64;
+
+    constexpr Nanos RISK_DEFAULT_RATE_WINDOW = NANOS_TO_SECS;
+
+    /// The checks in the order of their bit in RiskRejects.
+    enum class RiskCheck : uint8_t {
+        ORDER_FIELDS = 0,
+        ORDER_QTY = 1,
+        NOTIONAL = 2,
+        POSITION = 3,
+        PRICE_COLLAR = 4,
+        MESSAGE_RATE = 5
+    };
+
+    inline auto riskCheckToString(RiskCheck check) -> std::string {
+        switch(check){
+            case RiskCheck::ORDER_FIELDS:
+                return "ORDER_FIELDS";
+            case RiskCheck::ORDER_QTY:
+                return "ORDER_QTY";
+            case RiskCheck::NOTIONAL:
+                return "NOTIONAL";
+            case RiskCheck::POSITION:
+                return "POSITION";
+            case RiskCheck::PRICE_COLLAR:
+                return "PRICE_COLLAR";
+            case RiskCheck::MESSAGE_RATE:
+                return "MESSAGE_RATE";
+        }
+
+        return "UNKNOWN";
+    }
+
+    /// One bit per failed RiskCheck, 0 when the order passes.
+    typedef uint8_t RiskRejects;
+
+    constexpr auto riskRejectBit(RiskCheck check) noexcept -> RiskRejects {
+        return 1 << static_cast<uint8_t>(check);
+    }
+
+    inline auto riskRejectsToString(RiskRejects rejects) -> std::string {
+        if(!rejects)
+            return "NONE";
+
+        std::string result;
+        for(uint8_t check = 0; check <= static_cast<uint8_t>(RiskCheck::MESSAGE_RATE); check++){
+            if(rejects & riskRejectBit(static_cast<RiskCheck>(check)))
+                result += (result.empty() ? "" : "|") + riskCheckToString(static_cast<RiskCheck>(check));
+        }
+        return result;
+    }
+
+    /// New order as the risk stage sees it, ahead of matching.
+    struct RiskOrder {
+        ClientId client_id_ = ClientId_INVALID;
+        TickerId ticker_id_ = TickerId_INVALID;
+        OrderId order_id_ = OrderId_INVALID;
+        Side side_ = Side::INVALID;
+        Price price_ = Price_INVALID;
+        Qty qty_ = Qty_INVALID;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "RiskOrder["
+            << " client:" << clientIdToString(client_id_)
+            << " ticker:" << tickerIdToString(ticker_id_)
+            << " oid:" << orderIdToString(order_id_)
+            << " side:" << sideToString(side_)
+            << " qty:" << qtyToString(qty_)
+            << " price:" << priceToString(price_)
+            << "]";
+
+            return ss.str();
+        }
+    };
+
+    enum class RiskExecutionType : uint8_t {
+        INVALID = 0,
+        FILLED = 1,
+        CANCELED = 2
+    };
+
+    inline auto riskExecutionTypeToString(RiskExecutionType type) -> std::string {
+        switch(type){
+            case RiskExecutionType::FILLED:
+                return "FILLED";
+            case RiskExecutionType::CANCELED:
+                return "CANCELED";
+            case RiskExecutionType::INVALID:
+                return "INVALID";
+        }
+
+        return "UNKNOWN";
+    }
+
+    /// Execution report of an accepted order, qty_ is the filled or the canceled quantity.
+    struct RiskExecution {
+        RiskExecutionType type_ = RiskExecutionType::INVALID;
+        ClientId client_id_ = ClientId_INVALID;
+        TickerId ticker_id_ = TickerId_INVALID;
+        Side side_ = Side::INVALID;
+        Qty qty_ = Qty_INVALID;
+
+        auto toString() const {
+            std::stringstream ss;
+            ss << "RiskExecution["
+            << " type:" << riskExecutionTypeToString(type_)
+            << " client:" << clientIdToString(client_id_)
+            << " ticker:" << tickerIdToString(ticker_id_)
+            << " side:" << sideToString(side_)
+            << " qty:" << qtyToString(qty_)
+            << "]";
+
+            return ss.str();
+        }
+    };
+
+    struct RiskAccountLimits {
+        Qty max_order_qty_ = 0;
+        int64_t max_order_notional_ = 0;
+        uint32_t max_msgs_per_window_ = 0;
+    };
+
+    /// Pre-trade risk checks per account (ClientId) and instrument (TickerId): order size, order notional,
+    /// worst case position including working orders, price collar around a reference price and message rate.
+    /// Limits default to 0, an account or instrument rejects everything until it is configured.
+    /// Limits and exposures are kept as structure of arrays. checkBatch() evaluates the stateless checks over
+    /// a whole burst with AVX2, the position and rate checks that depend on earlier orders in the burst follow
+    /// in a branch free scalar pass. Prices times quantities are assumed to fit in 63 bits. Single threaded.
+    class RiskEngine final {
+        private:
+            const size_t max_accounts_;
+            const Nanos rate_window_;
+            const bool use_avx2_;
+
+            // Per account, the extra last entry absorbs orders with an invalid ClientId so no check branches.
+            std::vector<int64_t> max_order_qty_;
+            std::vector<int64_t> max_order_notional_;
+            std::vector<int64_t> max_msgs_per_window_;
+            std::vector<int64_t> msg_count_;
+            std::vector<int64_t> msg_window_;
+
+            // Per account and instrument at account * (ME_MAX_TICKERS + 1) + ticker, the last column absorbs invalid TickerIds.
+            std::vector<int64_t> max_position_;
+            std::vector<int64_t> position_;
+            std::vector<int64_t> open_buy_qty_;
+            std::vector<int64_t> open_sell_qty_;
+
+            // Per instrument, with the same extra entry.
+            std::array<int64_t, ME_MAX_TICKERS + 1> reference_price_{};
+            std::array<int64_t, ME_MAX_TICKERS + 1> max_price_deviation_{};
+
+            /// A burst staged as structure of arrays for the SIMD checks.
+            struct Batch {
+                alignas(32) std::array<int64_t, RISK_BATCH_SIZE> valid_;
+                alignas(32) std::array<int64_t, RISK_BATCH_SIZE> qty_;
+                alignas(32) std::array<int64_t, RISK_BATCH_SIZE> price_;
+                alignas(32) std::array<int64_t, RISK_BATCH_SIZE> max_order_qty_;
+                alignas(32) std::array<int64_t, RISK_BATCH_SIZE> max_order_notional_;
+                alignas(32) std::array<int64_t, RISK_BATCH_SIZE> reference_price_;
+                alignas(32) std::array<int64_t, RISK_BATCH_SIZE> max_price_deviation_;
+                alignas(32) std::array<int64_t, RISK_BATCH_SIZE> rejects_;
+                std::array<size_t, RISK_BATCH_SIZE> account_;
+                std::array<size_t, RISK_BATCH_SIZE> position_idx_;
+            };
+            Batch batch_;
+
+            std::array<RiskOrder, RISK_BATCH_SIZE> burst_;
+            std::array<RiskRejects, RISK_BATCH_SIZE> burst_rejects_;
+
+            auto positionIdx(size_t account, size_t ticker) const noexcept {
+                return account * (ME_MAX_TICKERS + 1) + ticker;
+            }
+
+            auto stage(const RiskOrder* orders, size_t n) noexcept -> void;
+            auto checkStateless(size_t n) noexcept -> void;
+            auto checkStateful(const RiskOrder* orders, size_t n, Nanos now, RiskRejects* rejects) noexcept -> void;
+
+        public:
+            explicit RiskEngine(size_t max_accounts = RISK_MAX_ACCOUNTS, Nanos rate_window = RISK_DEFAULT_RATE_WINDOW,
+                                bool use_avx2 = __builtin_cpu_supports("avx2"));
+
+            auto setAccountLimits(ClientId client_id, const RiskAccountLimits& limits) noexcept -> void;
+            auto setPositionLimit(ClientId client_id, TickerId ticker_id, int64_t max_position) noexcept -> void;
+
+            /// Orders for ticker_id must be priced within max_deviation of reference_price.
+            auto setPriceCollar(TickerId ticker_id, Price reference_price, Price max_deviation) noexcept -> void;
+
+            /// Checks n orders in sequence, accepted orders count as working towards the position limit.
+            /// Every order, accepted or not, counts towards the message rate of its account.
+            auto checkBatch(const RiskOrder* orders, size_t n, Nanos now, RiskRejects* rejects) noexcept -> void;
+
+            auto check(const RiskOrder& order, Nanos now) noexcept -> RiskRejects {
+                RiskRejects rejects;
+                checkBatch(&order, 1, now, &rejects);
+                return rejects;
+            }
+
+            /// Checks up to RISK_BATCH_SIZE orders from queue as one batch and calls on_checked(order, rejects) for each.
+            /// Returns the number of orders checked.
+            template<typename F>
+            auto drain(LFQueue<RiskOrder>& queue, Nanos now, F&& on_checked) noexcept -> size_t {
+                size_t n = 0;
+                for(auto next = queue.getNextReadLocation(); next && n < RISK_BATCH_SIZE; next = queue.getNextReadLocation()){
+                    burst_[n++] = *next;
+                    queue.updateNextToRead();
+                }
+
+                if(n){
+                    checkBatch(burst_.data(), n, now, burst_rejects_.data());
+                    for(size_t i = 0; i < n; i++)
+                        on_checked(burst_[i], burst_rejects_[i]);
+                }
+                return n;
+            }
+
+            /// Moves working quantity of an accepted order into the position on a fill, releases it on a cancel.
+            auto onExecution(const RiskExecution& execution) noexcept -> void;
+
+            /// Clears positions, working quantities and message counts, limits are kept. Undoes warm-up traffic.
+            auto resetExposures() noexcept -> void;
+
+            auto declareHotMemory(WarmUp& warm_up, const std::string& name) noexcept -> void;
+
+            auto getPosition(ClientId client_id, TickerId ticker_id) const noexcept {
+                return position_[positionIdx(client_id, ticker_id)];
+            }
+
+            auto getOpenQty(ClientId client_id, TickerId ticker_id, Side side) const noexcept {
+                return (side == Side::BUY) ? open_buy_qty_[positionIdx(client_id, ticker_id)] : open_sell_qty_[positionIdx(client_id, ticker_id)];
+            }
+
+            auto getMaxAccounts() const noexcept {
+                return max_accounts_;
+            }
+
+            auto usesAvx2() const noexcept {
+                return use_avx2_;
+            }
+
+            RiskEngine(const RiskEngine&) = delete;
+            RiskEngine(const RiskEngine&&) = delete;
+            RiskEngine& operator=(const RiskEngine&) = delete;
+            RiskEngine& operator=(const RiskEngine&&) = delete;
+    };
+}
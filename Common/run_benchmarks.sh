@@ -0,0 +1,10 @@
+#!/bin/bash
+
+# Usage: ./run_benchmarks.sh [benchmark args], results are written to benchmarks_<date>.json
+OUT=benchmarks_$(date +%Y%m%d_%H%M%S).json
+
+for f in $(ls cmake-build*/benchmarks); do
+  echo "Running "$f"...";
+  ./$f --json=$OUT "$@"
+  echo "Results written to "$OUT
+done
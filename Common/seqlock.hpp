@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#include "macros.hpp"
+
+namespace Common {
+    /// Single writer, multi reader versioned slot.
+    /// The writer never blocks, readers copy the value and retry if a write overlapped the copy.
+    /// Aligned to a cache line so adjacent slots in a SeqlockArray do not false share.
+    template<typename T>
+    class alignas(64) Seqlock final {
+        static_assert(std::is_trivially_copyable_v<T>, "Seqlock values should be trivially copyable.");
+
+        private:
+            // Odd while a write is in progress.
+            std::atomic<uint64_t> seq_{0};
+            T value_{};
+
+        public:
+            Seqlock() = default;
+
+            auto write(const T& value) noexcept {
+                const auto seq = seq_.load(std::memory_order_relaxed);
+                seq_.store(seq + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+
+                memcpy(&value_, &value, sizeof(T));
+
+                seq_.store(seq + 2, std::memory_order_release);
+            }
+
+            /// Single attempt, returns false if the copy may be torn.
+            auto tryRead(T* value) const noexcept -> bool {
+                const auto seq_before = seq_.load(std::memory_order_acquire);
+                if(seq_before & 1) [[unlikely]]
+                    return false;
+
+                memcpy(value, &value_, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                return seq_before == seq_.load(std::memory_order_relaxed);
+            }
+
+            auto read() const noexcept -> T {
+                T value;
+                while(!tryRead(&value)) [[unlikely]];
+
+                return value;
+            }
+
+            /// Number of completed writes.
+            auto getVersion() const noexcept {
+                return seq_.load(std::memory_order_acquire) / 2;
+            }
+
+            Seqlock(const Seqlock &) = delete;
+            Seqlock(const Seqlock &&) = delete;
+            Seqlock& operator=(const Seqlock &) = delete;
+            Seqlock& operator=(const Seqlock &&) = delete;
+    };
+
+    /// Fixed number of independently versioned Seqlock slots for keyed state, e.g. BBO per TickerId.
+    /// Each key has a single writer, any number of threads can read.
+    template<typename T>
+    class SeqlockArray final {
+        private:
+            std::vector<Seqlock<T>> slots_;
+
+        public:
+            explicit SeqlockArray(size_t num_slots) : slots_(num_slots) {}
+
+            auto write(size_t key, const T& value) noexcept {
+                slots_[key].write(value);
+            }
+
+            auto tryRead(size_t key, T* value) const noexcept -> bool {
+                return slots_[key].tryRead(value);
+            }
+
+            auto read(size_t key) const noexcept -> T {
+                return slots_[key].read();
+            }
+
+            auto getVersion(size_t key) const noexcept {
+                return slots_[key].getVersion();
+            }
+
+            auto size() const noexcept {
+                return slots_.size();
+            }
+
+            SeqlockArray() = delete;
+            SeqlockArray(const SeqlockArray &) = delete;
+            SeqlockArray(const SeqlockArray &&) = delete;
+            SeqlockArray& operator=(const SeqlockArray &) = delete;
+            SeqlockArray& operator=(const SeqlockArray &&) = delete;
+    };
+}
@@ -0,0 +1,98 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+
+#include "shm_lf_queue.hpp"
+
+namespace Common {
+    namespace {
+        constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+        auto isShmName(const std::string& name) noexcept {
+            return name.size() > 1 && name[0] == '/' && name.find('/', 1) == std::string::npos;
+        }
+    }
+
+    auto mapSharedMemory(const std::string& name, size_t* size, bool create, ShmSegmentId* id) -> void* {
+        const auto is_shm = isShmName(name);
+
+        // Files on a hugetlbfs mount have to be a multiple of the huge page size.
+        if(!is_shm)
+            *size = (*size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+        if(create){
+            // Start from a clean segment, a stale one may be left over from a crash.
+            is_shm ? shm_unlink(name.c_str()) : unlink(name.c_str());
+        }
+
+        const auto flags = create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR;
+        int fd = -1;
+
+        if(create){
+            fd = is_shm ? shm_open(name.c_str(), flags, 0600) : open(name.c_str(), flags, 0600);
+        } else {
+            // The creating process may not have got there yet.
+            const auto start = getCurrentNanos();
+            while((fd = is_shm ? shm_open(name.c_str(), flags, 0600) : open(name.c_str(), flags, 0600)) < 0 && errno == ENOENT && getCurrentNanos() - start < SHM_LF_QUEUE_ATTACH_TIMEOUT)
+                usleep(1000);
+        }
+        ASSERT(fd >= 0, "Failed to open shared memory: " + name + " errno:" + std::string(strerror(errno)));
+
+        struct stat st;
+        if(create){
+            ASSERT(ftruncate(fd, *size) == 0, "ftruncate() failed for shared memory: " + name + " errno:" + std::string(strerror(errno)));
+            ASSERT(fstat(fd, &st) == 0, "fstat() failed for shared memory: " + name + " errno:" + std::string(strerror(errno)));
+        } else {
+            // The creating process may have opened it but not sized it yet.
+            const auto start = getCurrentNanos();
+            while(true){
+                ASSERT(fstat(fd, &st) == 0, "fstat() failed for shared memory: " + name + " errno:" + std::string(strerror(errno)));
+                if(static_cast<size_t>(st.st_size) >= *size)
+                    break;
+
+                ASSERT(getCurrentNanos() - start < SHM_LF_QUEUE_ATTACH_TIMEOUT, "Timed out waiting for shared memory " + name + " to be sized: " + std::to_string(st.st_size) + " < " + std::to_string(*size));
+                usleep(1000);
+            }
+        }
+
+        *id = {st.st_dev, st.st_ino};
+
+        auto addr = mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+        ASSERT(addr != MAP_FAILED, "mmap() failed for shared memory: " + name + " errno:" + std::string(strerror(errno)));
+
+        close(fd);
+
+        return addr;
+    }
+
+    auto sharedMemoryId(const std::string& name) noexcept -> ShmSegmentId {
+        struct stat st;
+        if(isShmName(name)){
+            const auto fd = shm_open(name.c_str(), O_RDONLY, 0);
+            if(fd < 0)
+                return {};
+
+            const auto ok = (fstat(fd, &st) == 0);
+            close(fd);
+            if(!ok)
+                return {};
+        } else if(stat(name.c_str(), &st) != 0) {
+            return {};
+        }
+
+        return {st.st_dev, st.st_ino};
+    }
+
+    auto unmapSharedMemory(const std::string& name, void* addr, size_t size, bool remove) noexcept -> void {
+        munmap(addr, size);
+
+        if(remove)
+            isShmName(name) ? shm_unlink(name.c_str()) : unlink(name.c_str());
+    }
+
+    auto isProcessAlive(pid_t pid) noexcept -> bool {
+        return kill(pid, 0) == 0 || errno == EPERM;
+    }
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "macros.hpp"
+#include "time_utils.hpp"
+
+namespace Common {
+    constexpr uint64_t SHM_LF_QUEUE_MAGIC = 0x5545555146534c4c; // "LLSFQUEU"
+    constexpr uint32_t SHM_LF_QUEUE_VERSION = 2;
+
+    constexpr Nanos SHM_LF_QUEUE_ATTACH_TIMEOUT = 5 * NANOS_TO_SECS;
+
+    enum class ShmQueueRole : uint8_t {
+        PRODUCER = 0,
+        CONSUMER = 1
+    };
+
+    /// Liveness of one side of the queue, each side only writes its own.
+    struct alignas(64) ShmQueueEndpoint {
+        std::atomic<pid_t> pid_{0};
+        std::atomic<Nanos> heartbeat_{0};
+    };
+
+    /// Lives at the start of the shared memory segment. Only indices are stored so the layout
+    /// does not depend on where each process maps it.
+    struct ShmLFQueueHeader {
+        std::atomic<uint64_t> magic_{0};
+        uint32_t version_ = SHM_LF_QUEUE_VERSION;
+        uint32_t elem_size_ = 0;
+        uint64_t capacity_ = 0;
+
+        // Creation epoch, published with magic_. A segment whose creator is gone is left over from a crash.
+        pid_t creator_pid_ = 0;
+        Nanos created_at_ = 0;
+
+        // Monotonic, the slot is index % capacity_.
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+
+        ShmQueueEndpoint producer_;
+        ShmQueueEndpoint consumer_;
+    };
+
+    static_assert(std::atomic<size_t>::is_always_lock_free && std::atomic<Nanos>::is_always_lock_free && std::atomic<pid_t>::is_always_lock_free,
+                  "ShmLFQueue needs address free lock-free atomics.");
+
+    /// Identifies the segment behind a name, a creator that restarts replaces it with a new one.
+    struct ShmSegmentId {
+        dev_t dev_ = 0;
+        ino_t ino_ = 0;
+
+        auto operator==(const ShmSegmentId&) const -> bool = default;
+    };
+
+    /// Maps name into the address space. Names with a single leading '/' are POSIX shared memory objects,
+    /// anything else is treated as a file path, e.g. on a hugetlbfs mount. Returns the mapped size in *size
+    /// and the segment that was mapped in *id.
+    auto mapSharedMemory(const std::string& name, size_t* size, bool create, ShmSegmentId* id) -> void*;
+
+    /// The segment name currently refers to, a default ShmSegmentId if there is none.
+    auto sharedMemoryId(const std::string& name) noexcept -> ShmSegmentId;
+
+    auto unmapSharedMemory(const std::string& name, void* addr, size_t size, bool remove) noexcept -> void;
+
+    /// Returns false if the process is gone.
+    auto isProcessAlive(pid_t pid) noexcept -> bool;
+
+    /// Single producer single consumer lock-free queue in shared memory, for a producer and a consumer in different processes.
+    /// Same interface as LFQueue. The creating side sizes and initialises the segment, the other side attaches
+    /// and checks the layout. Each side registers its pid and can publish heartbeats for the other to check.
+    /// A creator that restarts replaces the segment: attaching skips a segment whose creator is dead or that is
+    /// no longer the one behind the name, and a side already attached sees needsReattach() and rebuilds the queue.
+    template<typename T>
+    class ShmLFQueue final {
+        static_assert(std::is_trivially_copyable_v<T>, "ShmLFQueue elements should be trivially copyable.");
+
+        private:
+            const std::string name_;
+            const ShmQueueRole role_;
+            const bool owner_;
+
+            ShmSegmentId segment_id_;
+            size_t mapped_size_ = 0;
+            ShmLFQueueHeader* header_ = nullptr;
+            T* slots_ = nullptr;
+            size_t capacity_ = 0;
+
+            auto self() noexcept -> ShmQueueEndpoint& {
+                return (role_ == ShmQueueRole::PRODUCER) ? header_->producer_ : header_->consumer_;
+            }
+
+            auto peer() const noexcept -> const ShmQueueEndpoint& {
+                return (role_ == ShmQueueRole::PRODUCER) ? header_->consumer_ : header_->producer_;
+            }
+
+            static constexpr auto slotsOffset() noexcept {
+                return (sizeof(ShmLFQueueHeader) + 63) & ~static_cast<size_t>(63);
+            }
+
+            auto map(size_t capacity, bool create) {
+                mapped_size_ = slotsOffset() + capacity * sizeof(T);
+                auto addr = reinterpret_cast<char*>(mapSharedMemory(name_, &mapped_size_, create, &segment_id_));
+
+                header_ = reinterpret_cast<ShmLFQueueHeader*>(addr);
+                slots_ = reinterpret_cast<T*>(addr + slotsOffset());
+                capacity_ = capacity;
+                return addr;
+            }
+
+            /// Claims the role with a CAS so that of two processes attaching at once only one gets it. The slot of
+            /// a dead holder is taken over with a CAS as well, several attachers may have seen it dead.
+            auto claimRole() noexcept {
+                const auto pid = getpid();
+                const auto role_name = std::string(role_ == ShmQueueRole::PRODUCER ? "producer" : "consumer");
+                pid_t holder = 0;
+                if(!self().pid_.compare_exchange_strong(holder, pid) && holder != pid){
+                    ASSERT(!isProcessAlive(holder), "ShmLFQueue " + name_ + " already has a live " + role_name + " pid:" + std::to_string(holder));
+
+                    const auto dead_holder = holder;
+                    const auto taken_over = self().pid_.compare_exchange_strong(holder, pid);
+                    ASSERT(taken_over, "ShmLFQueue " + name_ + " " + role_name + " of dead pid:" + std::to_string(dead_holder) + " was taken over by pid:" + std::to_string(holder));
+                }
+            }
+
+            /// Leaves the slot alone if another process has taken it over.
+            auto releaseRole() noexcept {
+                auto pid = getpid();
+                self().pid_.compare_exchange_strong(pid, 0);
+            }
+
+            /// Maps the segment behind name_ once its creator has initialised it. Retries while it is a leftover of a
+            /// crashed creator or gets replaced before the role is claimed, until SHM_LF_QUEUE_ATTACH_TIMEOUT.
+            auto attach(size_t capacity) {
+                const auto start = getCurrentNanos();
+                while(true){
+                    map(capacity, false);
+
+                    while(header_->magic_.load(std::memory_order_acquire) != SHM_LF_QUEUE_MAGIC){
+                        ASSERT(getCurrentNanos() - start < SHM_LF_QUEUE_ATTACH_TIMEOUT, "Timed out waiting for ShmLFQueue " + name_ + " to be initialised.");
+                        usleep(1000);
+                    }
+
+                    ASSERT(header_->version_ == SHM_LF_QUEUE_VERSION, "ShmLFQueue " + name_ + " version mismatch, found:" + std::to_string(header_->version_));
+                    ASSERT(header_->elem_size_ == sizeof(T), "ShmLFQueue " + name_ + " element size mismatch, expected:" + std::to_string(sizeof(T)) + " found:" + std::to_string(header_->elem_size_));
+                    ASSERT(header_->capacity_ == capacity, "ShmLFQueue " + name_ + " capacity mismatch, expected:" + std::to_string(capacity) + " found:" + std::to_string(header_->capacity_));
+
+                    const auto creator_pid = header_->creator_pid_;
+                    if(isProcessAlive(creator_pid)){
+                        claimRole();
+                        if(sharedMemoryId(name_) == segment_id_)
+                            return;
+                        releaseRole();
+                    }
+
+                    unmapSharedMemory(name_, header_, mapped_size_, false);
+                    ASSERT(getCurrentNanos() - start < SHM_LF_QUEUE_ATTACH_TIMEOUT, "Timed out waiting for ShmLFQueue " + name_ + " to be recreated, stale creator pid:" + std::to_string(creator_pid));
+                    usleep(1000);
+                }
+            }
+
+        public:
+            /// create = true builds a fresh segment of capacity elements, replacing any stale one with the same name.
+            /// create = false attaches to an existing segment, capacity must match.
+            ShmLFQueue(const std::string& name, size_t capacity, ShmQueueRole role, bool create) : name_(name), role_(role), owner_(create) {
+                if(create){
+                    auto addr = map(capacity, true);
+                    header_ = new(addr) ShmLFQueueHeader();
+                    header_->elem_size_ = sizeof(T);
+                    header_->capacity_ = capacity;
+                    header_->creator_pid_ = getpid();
+                    header_->created_at_ = getCurrentNanos();
+                    header_->magic_.store(SHM_LF_QUEUE_MAGIC, std::memory_order_release);
+                    claimRole();
+                } else {
+                    attach(capacity);
+                }
+
+                heartbeat();
+            }
+
+            ~ShmLFQueue() {
+                releaseRole();
+                // A restarted creator may already have replaced the segment, its name is not ours to remove then.
+                unmapSharedMemory(name_, header_, mapped_size_, owner_ && sharedMemoryId(name_) == segment_id_);
+            }
+
+            auto getNextWriteLocation() noexcept {
+                return &slots_[header_->tail_.load(std::memory_order_relaxed) % capacity_];
+            }
+
+            auto getNextReadLocation() noexcept -> T* {
+                return size() ? &slots_[header_->head_.load(std::memory_order_relaxed) % capacity_] : nullptr;
+            }
+
+            auto size() const noexcept {
+                return header_->tail_.load(std::memory_order_acquire) - header_->head_.load(std::memory_order_acquire);
+            }
+
+            auto capacity() const noexcept {
+                return capacity_;
+            }
+
+            // Like LFQueue, does not check for overwrite.
+            auto updateNextToWrite() noexcept {
+                header_->tail_.store(header_->tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            auto updateNextToRead() noexcept {
+                // Not ASSERT(), its message would be built on every call.
+                if(!size()) [[unlikely]]
+                    FATAL("Read an invalid element from ShmLFQueue " + name_);
+                header_->head_.store(header_->head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            /// Publish that this side is alive, call from the idle loop.
+            auto heartbeat() noexcept {
+                self().heartbeat_.store(getCurrentNanos(), std::memory_order_relaxed);
+            }
+
+            /// The peer is alive if its process exists and, when max_heartbeat_age > 0, it has heartbeated recently enough.
+            auto isPeerAlive(Nanos max_heartbeat_age = 0) const noexcept {
+                const auto pid = peer().pid_.load();
+                if(!pid || !isProcessAlive(pid))
+                    return false;
+
+                return !max_heartbeat_age || (getCurrentNanos() - peer().heartbeat_.load(std::memory_order_relaxed) <= max_heartbeat_age);
+            }
+
+            /// True once this segment is orphaned: its creator is gone or name_ refers to a newer segment.
+            /// Destroy the queue and construct it again to follow a restarted creator. Makes syscalls, call from the idle loop.
+            auto needsReattach() const noexcept {
+                return !isProcessAlive(header_->creator_pid_) || sharedMemoryId(name_) != segment_id_;
+            }
+
+            auto getCreatorPid() const noexcept {
+                return header_->creator_pid_;
+            }
+
+            auto getCreatedAt() const noexcept {
+                return header_->created_at_;
+            }
+
+            ShmLFQueue() = delete;
+            ShmLFQueue(const ShmLFQueue &) = delete;
+            ShmLFQueue(const ShmLFQueue &&) = delete;
+            ShmLFQueue& operator=(const ShmLFQueue &) = delete;
+            ShmLFQueue& operator=(const ShmLFQueue &&) = delete;
+    };
+}
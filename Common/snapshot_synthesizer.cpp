@@ -0,0 +1,126 @@
+#include "snapshot_synthesizer.hpp"
+
+namespace Common {
+    SnapshotSynthesizer::SnapshotSynthesizer(MDPMarketUpdateLFQueue* market_updates, MDPMarketUpdateLFQueue* snapshot_updates, Nanos snapshot_interval, int core_id)
+        : market_updates_(market_updates), snapshot_updates_(snapshot_updates), logger_("snapshot_synthesizer.log"), core_id_(core_id),
+          ticker_orders_(ME_MAX_TICKERS, std::vector<MEMarketUpdate*>(ME_MAX_ORDER_IDS, nullptr)), order_pool_(ME_MAX_ORDER_IDS), snapshot_interval_(snapshot_interval) {
+    }
+
+    SnapshotSynthesizer::~SnapshotSynthesizer() {
+        stop();
+    }
+
+    auto SnapshotSynthesizer::start() -> void {
+        run_ = true;
+        thread_ = setAndCreateThread(core_id_, "Common/SnapshotSynthesizer", [this](){ run(); });
+        ASSERT(thread_ != nullptr, "Failed to start SnapshotSynthesizer thread.");
+    }
+
+    auto SnapshotSynthesizer::stop() -> void {
+        run_ = false;
+
+        if(thread_){
+            thread_->join();
+            delete thread_;
+            thread_ = nullptr;
+        }
+    }
+
+    auto SnapshotSynthesizer::addToSnapshot(const MDPMarketUpdate* market_update) noexcept -> void {
+        const auto& me_market_update = market_update->me_market_update_;
+
+        // Not ASSERT(), its message would be built for every incremental.
+        if(market_update->seq_num_ != last_inc_seq_num_ + 1) [[unlikely]]
+            FATAL("Expected incremental seq_nums to increase. last:" + std::to_string(last_inc_seq_num_) + " " + market_update->toString());
+
+        switch(me_market_update.type_){
+            case MarketUpdateType::ADD: {
+                auto& order = ticker_orders_.at(me_market_update.ticker_id_).at(me_market_update.order_id_);
+                if(order != nullptr) [[unlikely]]
+                    FATAL("Received ADD for an existing order: " + me_market_update.toString());
+                order = order_pool_.allocate(me_market_update);
+            }
+                break;
+            case MarketUpdateType::MODIFY: {
+                auto order = ticker_orders_.at(me_market_update.ticker_id_).at(me_market_update.order_id_);
+                if(order == nullptr) [[unlikely]]
+                    FATAL("Received MODIFY for an unknown order: " + me_market_update.toString());
+                order->qty_ = me_market_update.qty_;
+                order->price_ = me_market_update.price_;
+            }
+                break;
+            case MarketUpdateType::CANCEL: {
+                auto& order = ticker_orders_.at(me_market_update.ticker_id_).at(me_market_update.order_id_);
+                if(order == nullptr) [[unlikely]]
+                    FATAL("Received CANCEL for an unknown order: " + me_market_update.toString());
+                order_pool_.deallocate(order);
+                order = nullptr;
+            }
+                break;
+            case MarketUpdateType::CLEAR:
+            case MarketUpdateType::TRADE:
+            case MarketUpdateType::SNAPSHOT_START:
+            case MarketUpdateType::SNAPSHOT_END:
+            case MarketUpdateType::INVALID:
+                break;
+        }
+
+        last_inc_seq_num_ = market_update->seq_num_;
+    }
+
+    auto SnapshotSynthesizer::publish(const MEMarketUpdate& me_market_update) noexcept -> void {
+        auto next_write = snapshot_updates_->getNextWriteLocation();
+        next_write->seq_num_ = snapshot_size_++;
+        next_write->me_market_update_ = me_market_update;
+        snapshot_updates_->updateNextToWrite();
+    }
+
+    auto SnapshotSynthesizer::publishSnapshot() noexcept -> void {
+        logger_.log("%:% %() % Publishing snapshot last_inc_seq_num:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), last_inc_seq_num_);
+
+        snapshot_size_ = 0;
+
+        // SNAPSHOT_START / SNAPSHOT_END carry the last applied incremental seq_num in order_id_.
+        MEMarketUpdate me_market_update;
+        me_market_update.type_ = MarketUpdateType::SNAPSHOT_START;
+        me_market_update.order_id_ = last_inc_seq_num_;
+        publish(me_market_update);
+
+        for(size_t ticker_id = 0; ticker_id < ticker_orders_.size(); ticker_id++){
+            me_market_update = MEMarketUpdate{};
+            me_market_update.type_ = MarketUpdateType::CLEAR;
+            me_market_update.ticker_id_ = ticker_id;
+            publish(me_market_update);
+
+            for(const auto order : ticker_orders_[ticker_id]){
+                if(order)
+                    publish(*order);
+            }
+        }
+
+        me_market_update = MEMarketUpdate{};
+        me_market_update.type_ = MarketUpdateType::SNAPSHOT_END;
+        me_market_update.order_id_ = last_inc_seq_num_;
+        publish(me_market_update);
+
+        logger_.log("%:% %() % Published snapshot of % orders.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), snapshot_size_ - 1 - ticker_orders_.size() - 1);
+    }
+
+    auto SnapshotSynthesizer::run() noexcept -> void {
+        logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+
+        last_snapshot_time_ = getCurrentNanos();
+
+        while(run_){
+            for(auto market_update = market_updates_->getNextReadLocation(); market_updates_->size() && market_update; market_update = market_updates_->getNextReadLocation()){
+                addToSnapshot(market_update);
+                market_updates_->updateNextToRead();
+            }
+
+            if(getCurrentNanos() - last_snapshot_time_ > snapshot_interval_){
+                last_snapshot_time_ = getCurrentNanos();
+                publishSnapshot();
+            }
+        }
+    }
+}
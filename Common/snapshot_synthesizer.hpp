@@ -0,0 +1,59 @@
+#pragma once
+
+#include "types.hpp"
+#include "thread_utils.hpp"
+#include "mem_pool.hpp"
+#include "logging.hpp"
+#include "market_update.hpp"
+
+namespace Common {
+    /// Consumes the sequenced incremental stream, keeps a shadow copy of every book and
+    /// periodically publishes a full snapshot on a separate channel.
+    /// Runs on its own thread so the incremental publisher only pays for one queue write.
+    class SnapshotSynthesizer {
+        private:
+            MDPMarketUpdateLFQueue* market_updates_ = nullptr;
+            MDPMarketUpdateLFQueue* snapshot_updates_ = nullptr;
+
+            Logger logger_;
+
+            std::atomic<bool> run_{false};
+            std::thread* thread_ = nullptr;
+            int core_id_ = -1;
+
+            std::string time_str_;
+
+            // Shadow books: ticker_orders_[ticker_id][order_id] -> live order or nullptr.
+            std::vector<std::vector<MEMarketUpdate*>> ticker_orders_;
+            Mempool<MEMarketUpdate> order_pool_;
+
+            size_t last_inc_seq_num_ = 0;
+            size_t snapshot_size_ = 0;
+
+            const Nanos snapshot_interval_;
+            Nanos last_snapshot_time_ = 0;
+
+            auto publish(const MEMarketUpdate& me_market_update) noexcept -> void;
+
+        public:
+            SnapshotSynthesizer(MDPMarketUpdateLFQueue* market_updates, MDPMarketUpdateLFQueue* snapshot_updates, Nanos snapshot_interval, int core_id = -1);
+
+            ~SnapshotSynthesizer();
+
+            auto start() -> void;
+
+            auto stop() -> void;
+
+            auto addToSnapshot(const MDPMarketUpdate* market_update) noexcept -> void;
+
+            auto publishSnapshot() noexcept -> void;
+
+            auto run() noexcept -> void;
+
+            SnapshotSynthesizer() = delete;
+            SnapshotSynthesizer(const SnapshotSynthesizer&) = delete;
+            SnapshotSynthesizer(const SnapshotSynthesizer&&) = delete;
+            SnapshotSynthesizer& operator=(const SnapshotSynthesizer&) = delete;
+            SnapshotSynthesizer& operator=(const SnapshotSynthesizer&&) = delete;
+    };
+}
@@ -25,6 +25,7 @@ namespace Common {
         bool is_udp_ = false;
         bool is_listening_ = false;
         bool needs_so_timestamp_ = false;
+        bool reuse_port_ = false;
 
         auto toString() const {
             std::stringstream ss;
@@ -34,6 +35,7 @@ namespace Common {
             << " is_udp:" << is_udp_
             << " is_listening:" << is_listening_
             << " needs_SO_timestamp:" << needs_so_timestamp_
+            << " reuse_port:" << reuse_port_
             << "]";
             
             return ss.str();
@@ -76,7 +78,7 @@ namespace Common {
 
     inline auto enableSOTimestamp(int fd) -> bool {
         int yes = 1;
-        return (setsockopt(fd, IPPROTO_TCP, SO_TIMESTAMP, reinterpret_cast<const void*>(&yes), sizeof(yes)) != -1);
+        return (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMP, reinterpret_cast<const void*>(&yes), sizeof(yes)) != -1);
     }
 
     /// Add / Join membership / subscription to the multicast stream specified and on the interface specified.
@@ -115,6 +117,11 @@ namespace Common {
             if(sock_cfg_.is_listening_){
                 ASSERT(setsockopt(sock_fd, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const void*>(&yes), sizeof(yes)) == 0, "setsockopt() SO_REUSEADDR failed. errno: " + std::string(strerror(errno)));
 
+                // Several listeners on the same port, the kernel spreads new connections across them.
+                if(sock_cfg_.reuse_port_){
+                    ASSERT(setsockopt(sock_fd, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const void*>(&yes), sizeof(yes)) == 0, "setsockopt() SO_REUSEPORT failed. errno: " + std::string(strerror(errno)));
+                }
+
                 const sockaddr_in addr{AF_INET, htons(sock_cfg_.port_), {htonl(INADDR_ANY)}, {}};
                 ASSERT(bind(sock_fd, sock_cfg_.is_udp_ ? reinterpret_cast<const struct sockaddr*>(&addr) : rp->ai_addr, sizeof(addr)) == 0, "bind() failed. errno: " + std::string(strerror(errno)));
             } else {
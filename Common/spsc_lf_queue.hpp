@@ -2,10 +2,13 @@
 
 #include<vector>
 #include<atomic>
+#include<string>
 
 #include "macros.hpp"
 
 namespace Common {
+    class WarmUp;
+
     // A single producer single consumer lock-free queue
     template<typename T>
     class LFQueue final {
@@ -44,6 +47,13 @@ namespace Common {
                 num_elem--;
             }
 
+            /// W is WarmUp, a template parameter so that this header gets by with its declaration.
+            /// concurrent when the consumer or producer thread already runs, see WarmUp::declareHotMemory().
+            template<typename W = WarmUp>
+            auto declareHotMemory(W& warm_up, const std::string& name, bool concurrent = false) noexcept -> void {
+                warm_up.declareHotMemory(name, queue_.data(), queue_.size() * sizeof(T), concurrent);
+            }
+
 
             LFQueue() = delete;
             LFQueue(const LFQueue &) = delete;
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#include "journal.hpp"
+
+namespace Common {
+    constexpr size_t TCP_CAPTURE_CHUNK_SIZE = 96;
+
+    /// One chunk of the bytes returned by a single read on a socket.
+    /// Reads larger than TCP_CAPTURE_CHUNK_SIZE are split over consecutive records, the last one has last_chunk_ set.
+    struct TCPCaptureRecord {
+        Nanos kernel_time_ = 0;
+        Nanos user_time_ = 0;
+        int32_t stream_id_ = -1;
+        uint16_t len_ = 0;
+        uint8_t last_chunk_ = 0;
+        uint8_t reserved_ = 0;
+        char data_[TCP_CAPTURE_CHUNK_SIZE];
+    };
+
+    static_assert(sizeof(TCPCaptureRecord) + sizeof(uint64_t) == 128, "TCPCaptureRecord journal records should be 128 bytes.");
+
+    /// Records inbound bytes with kernel and user timestamps into a Journal for TCPReplayer.
+    /// Must be driven from the single thread that calls sendAndRecv() on the captured sockets.
+    class TCPCapture final {
+        private:
+            Journal<TCPCaptureRecord> journal_;
+            TCPCaptureRecord record_;
+
+        public:
+            explicit TCPCapture(const std::string& prefix, Nanos durability_lag = 10 * NANOS_TO_MILLIS) : journal_(prefix, durability_lag) {}
+
+            auto capture(int stream_id, const char* data, size_t len, Nanos kernel_time, Nanos user_time) noexcept -> void {
+                record_.kernel_time_ = kernel_time;
+                record_.user_time_ = user_time;
+                record_.stream_id_ = stream_id;
+
+                do {
+                    const auto chunk_len = std::min(len, TCP_CAPTURE_CHUNK_SIZE);
+                    record_.len_ = chunk_len;
+                    record_.last_chunk_ = (chunk_len == len);
+                    memcpy(record_.data_, data, chunk_len);
+
+                    journal_.append(record_);
+
+                    data += chunk_len;
+                    len -= chunk_len;
+                } while(len);
+            }
+
+            TCPCapture() = delete;
+            TCPCapture(const TCPCapture&) = delete;
+            TCPCapture(const TCPCapture&&) = delete;
+            TCPCapture& operator=(const TCPCapture&) = delete;
+            TCPCapture& operator=(const TCPCapture&&) = delete;
+    };
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "tcp_server.hpp"
+#include "spsc_lf_queue.hpp"
+#include "thread_utils.hpp"
+
+namespace Common {
+    /// N TCPServer reactors on the same port via SO_REUSEPORT, each polled by its own pinned thread.
+    /// A reactor owns its listener, epoll instance, sockets and Logger exclusively. recv_callback_ runs on the
+    /// reactor thread and hands its output downstream through that reactor's LFQueue<T>, one queue per reactor.
+    template<typename T>
+    class TCPReactorPool final {
+        public:
+            typedef std::function<void(TCPSocket* s, Nanos rx_time, LFQueue<T>* downstream)> RecvCallbackType;
+
+        private:
+            struct Reactor {
+                Logger* logger_ = nullptr;
+                TCPServer* server_ = nullptr;
+                LFQueue<T>* downstream_ = nullptr;
+                std::thread* thread_ = nullptr;
+                int core_id_ = -1;
+                std::function<void()> run_;
+            };
+
+            const std::string name_;
+            std::vector<Reactor> reactors_;
+
+            std::atomic<bool> running_{false};
+
+        public:
+            /// One reactor per entry of core_ids, -1 leaves that reactor unpinned.
+            TCPReactorPool(const std::string& name, const std::vector<int>& core_ids, size_t queue_size, RecvCallbackType recv_callback,
+                           size_t socket_buffer_size = TCPBufferSize) : name_(name), reactors_(core_ids.size()) {
+                ASSERT(!core_ids.empty(), "TCPReactorPool " + name_ + " needs at least one reactor.");
+
+                for(size_t i = 0; i < reactors_.size(); i++){
+                    auto& reactor = reactors_[i];
+                    reactor.core_id_ = core_ids[i];
+                    reactor.logger_ = new Logger(name_ + "_reactor_" + std::to_string(i) + ".log");
+                    reactor.server_ = new TCPServer(*reactor.logger_, socket_buffer_size);
+                    reactor.downstream_ = new LFQueue<T>(queue_size);
+
+                    auto downstream = reactor.downstream_;
+                    reactor.server_->recv_callback_ = [recv_callback, downstream](TCPSocket* s, Nanos rx_time){
+                        recv_callback(s, rx_time, downstream);
+                    };
+                    reactor.server_->recv_finished_callback_ = [](){};
+
+                    auto server = reactor.server_;
+                    reactor.run_ = [this, server](){
+                        while(running_){
+                            server->poll();
+                            server->sendAndRecv();
+                        }
+                    };
+                }
+            }
+
+            ~TCPReactorPool() {
+                stop();
+
+                for(auto& reactor : reactors_){
+                    delete reactor.server_;
+                    delete reactor.downstream_;
+                    delete reactor.logger_;
+                }
+            }
+
+            /// Binds every reactor to iface:port and starts the reactor threads.
+            auto start(const std::string& iface, int port) -> void {
+                for(auto& reactor : reactors_)
+                    reactor.server_->listen(iface, port, true);
+
+                running_ = true;
+                for(size_t i = 0; i < reactors_.size(); i++){
+                    auto& reactor = reactors_[i];
+                    reactor.thread_ = setAndCreateThread(reactor.core_id_, "Common/TCPReactorPool " + name_ + " " + std::to_string(i), reactor.run_);
+                    ASSERT(reactor.thread_ != nullptr, "Failed to start reactor " + std::to_string(i) + " for " + name_);
+                }
+            }
+
+            auto stop() -> void {
+                running_ = false;
+
+                for(auto& reactor : reactors_){
+                    if(reactor.thread_){
+                        reactor.thread_->join();
+                        delete reactor.thread_;
+                        reactor.thread_ = nullptr;
+                    }
+                }
+            }
+
+            auto numReactors() const noexcept {
+                return reactors_.size();
+            }
+
+            /// Consumed by the single downstream stage of reactor i.
+            auto getQueue(size_t i) noexcept {
+                return reactors_[i].downstream_;
+            }
+
+            /// Only safe to call once the pool is stopped.
+            auto getNumSockets(size_t i) const noexcept {
+                return reactors_[i].server_->getNumSockets();
+            }
+
+            auto getLogger(size_t i) const noexcept -> const Logger& {
+                return *reactors_[i].logger_;
+            }
+
+            TCPReactorPool() = delete;
+            TCPReactorPool(const TCPReactorPool &) = delete;
+            TCPReactorPool(const TCPReactorPool &&) = delete;
+            TCPReactorPool& operator=(const TCPReactorPool &) = delete;
+            TCPReactorPool& operator=(const TCPReactorPool &&) = delete;
+    };
+}
@@ -0,0 +1,73 @@
+#include "tcp_replayer.hpp"
+
+namespace Common {
+    TCPReplayer::TCPReplayer(const std::string& prefix, Logger& logger) : prefix_(prefix), logger_(logger) {
+        pending_data_.resize(TCPBufferSize);
+    }
+
+    TCPReplayer::~TCPReplayer() {
+        // The FDs are the captured ones, not ours to close.
+        for(auto socket : sockets_){
+            socket->setFD(-1);
+            delete socket;
+        }
+    }
+
+    auto TCPReplayer::getSocket(int stream_id) -> TCPSocket* {
+        const auto itr = std::find_if(sockets_.begin(), sockets_.end(), [stream_id](auto socket){ return socket->getFD() == stream_id; });
+        if(itr != sockets_.end()) [[likely]]
+            return *itr;
+
+        logger_.log("%:% %() % new replay stream: %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), stream_id);
+
+        auto socket = new TCPSocket(logger_);
+        socket->setFD(stream_id);
+        socket->setCallback(recv_callback_);
+        sockets_.push_back(socket);
+
+        return socket;
+    }
+
+    auto TCPReplayer::replay(double speed) -> size_t {
+        logger_.log("%:% %() % replaying % speed:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), prefix_, speed);
+
+        JournalReader<TCPCaptureRecord> reader(prefix_);
+
+        size_t num_reads = 0;
+        Nanos first_capture_time = 0;
+        Nanos replay_start_time = 0;
+        pending_len_ = 0;
+
+        reader.replay([&](uint64_t, const TCPCaptureRecord& record){
+            memcpy(pending_data_.data() + pending_len_, record.data_, record.len_);
+            pending_len_ += record.len_;
+
+            if(!record.last_chunk_)
+                return;
+
+            if(!num_reads) [[unlikely]] {
+                first_capture_time = record.user_time_;
+                replay_start_time = getCurrentNanos();
+            }
+
+            if(speed > 0){
+                const auto replay_time = replay_start_time + static_cast<Nanos>((record.user_time_ - first_capture_time) / speed);
+                while(getCurrentNanos() < replay_time);
+            }
+
+            auto socket = getSocket(record.stream_id_);
+            socket->injectRecv(pending_data_.data(), pending_len_, record.kernel_time_);
+            socket->next_valid_write_idx_ = 0;
+            pending_len_ = 0;
+
+            if(recv_finished_callback_)
+                recv_finished_callback_();
+
+            num_reads++;
+        });
+
+        logger_.log("%:% %() % replayed % reads from %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), num_reads, prefix_);
+
+        return num_reads;
+    }
+}
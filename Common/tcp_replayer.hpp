@@ -0,0 +1,42 @@
+#pragma once
+
+#include "tcp_socket.hpp"
+#include "tcp_capture.hpp"
+
+namespace Common {
+    /// Feeds a TCPCapture back through recv_callback_ without real sockets.
+    /// Every captured stream gets its own TCPSocket whose FD is the captured FD, anything the callbacks send is discarded.
+    class TCPReplayer {
+        private:
+            const std::string prefix_;
+
+            Logger& logger_;
+            std::string time_str_;
+
+            std::vector<TCPSocket*> sockets_;
+
+            // Chunks of a single captured read are reassembled here.
+            std::vector<char> pending_data_;
+            size_t pending_len_ = 0;
+
+            auto getSocket(int stream_id) -> TCPSocket*;
+
+        public:
+            std::function<void(TCPSocket* s, Nanos rx_time)> recv_callback_ = nullptr;
+            std::function<void()> recv_finished_callback_ = nullptr;
+
+            TCPReplayer(const std::string& prefix, Logger& logger);
+
+            ~TCPReplayer();
+
+            /// speed is relative to the captured pacing: 1 replays in real time, N replays N times faster
+            /// and 0 replays as fast as possible. Returns the number of reads replayed.
+            auto replay(double speed) -> size_t;
+
+            TCPReplayer() = delete;
+            TCPReplayer(const TCPReplayer&) = delete;
+            TCPReplayer(const TCPReplayer&&) = delete;
+            TCPReplayer& operator=(const TCPReplayer&) = delete;
+            TCPReplayer& operator=(const TCPReplayer&&) = delete;
+    };
+}
@@ -2,17 +2,50 @@
 
 namespace Common {
     auto TCPServer::addToEpollList(TCPSocket* socket){
-        epoll_event ev{EPOLLET | EPOLLIN, {reinterpret_cast<void*>(socket)}};
+        epoll_event ev{EPOLLET | EPOLLIN | EPOLLRDHUP, {reinterpret_cast<void*>(socket)}};
 
         return !epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket->getFD(), &ev);
     }
 
-    auto TCPServer::listen(const std::string& iface, int port) -> void {
+    auto TCPServer::addToSocketList(std::vector<TCPSocket*>& list, TCPSocket* socket, uint8_t list_bit) noexcept -> void {
+        auto lists = socket_lists_.find(socket);
+        if(!lists){
+            socket_lists_.insert(socket, list_bit);
+            list.push_back(socket);
+        } else if(!(*lists & list_bit)){
+            *lists |= list_bit;
+            list.push_back(socket);
+        }
+    }
+
+    auto TCPServer::closeSocket(TCPSocket* socket) noexcept -> void {
+        logger_.log("%:% %() % closed socket: %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket->getFD());
+
+        if(disconnect_callback_)
+            disconnect_callback_(socket);
+
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, socket->getFD(), nullptr);
+        socket_lists_.erase(socket);
+        std::erase(receive_sockets_, socket);
+        std::erase(send_sockets_, socket);
+        std::erase(sockets_, socket);
+        delete socket;
+    }
+
+    TCPServer::~TCPServer() {
+        for(auto socket : sockets_)
+            delete socket;
+
+        if(epoll_fd_ >= 0)
+            close(epoll_fd_);
+    }
+
+    auto TCPServer::listen(const std::string& iface, int port, bool reuse_port) -> void {
         epoll_fd_ = epoll_create(1);
 
         ASSERT(epoll_fd_ != 1, "epoll_create() failed error: " + std::string(strerror(errno)));
 
-        ASSERT(listener_socket_.connect("", iface, port, true) >= 0, "listener socket failed to connect. iface: " + iface + " port: " + std::to_string(port) + " error: " + std::string(strerror(errno)));
+        ASSERT(listener_socket_.connect("", iface, port, true, reuse_port) >= 0, "listener socket failed to connect. iface: " + iface + " port: " + std::to_string(port) + " error: " + std::string(strerror(errno)));
 
         ASSERT(addToEpollList(&listener_socket_), "epoll_ctl() failed. errno: " + std::string(strerror(errno)));
     }
@@ -24,19 +57,35 @@ namespace Common {
 
         auto recv = false;
 
-        std::for_each(receive_sockets_.begin(), receive_sockets_.end(), [&recv](auto socket){
+        std::for_each(receive_sockets_.begin(), receive_sockets_.end(), [this, &recv](auto socket){
             recv |= socket->sendAndRecv();
+            if(socket->isClosed()) [[unlikely]]
+                closed_sockets_.push_back(socket);
         });
 
         if(recv){
             recv_finished_callback_();
         }
+
+        // After recv_finished_callback_, the data read before the FIN is processed first.
+        if(!closed_sockets_.empty()) [[unlikely]] {
+            for(auto socket : closed_sockets_)
+                closeSocket(socket);
+            closed_sockets_.clear();
+        }
     }
 
     auto TCPServer::poll() noexcept -> void {
-        const int max_events_ = 1 + send_sockets_.size() + receive_sockets_.size();
+        const int max_events_ = std::min<size_t>(MaxEpollEvents, 1 + send_sockets_.size() + receive_sockets_.size());
 
-        const int n = epoll_wait(epoll_fd_, events_, max_events_, 0);
+        int timeout_millis = 0;
+        if(timer_wheel_){
+            const auto wait = std::min(timer_wheel_->nextDeadline() - getCurrentNanos(), MaxTimerPollWait);
+            // Round up, waking before the deadline would just go round the loop again.
+            timeout_millis = (wait > 0) ? (wait + NANOS_TO_MILLIS - 1) / NANOS_TO_MILLIS : 0;
+        }
+
+        const int n = epoll_wait(epoll_fd_, events_, max_events_, timeout_millis);
 
         bool have_new_connections_ = false;
 
@@ -44,7 +93,8 @@ namespace Common {
             const auto& event = events_[i];
             auto socket = reinterpret_cast<TCPSocket*>(event.data.ptr);
 
-            if(event.events & EPOLLIN){
+            // A FIN or an error shows up as a read, sendAndRecv() then finds the socket closed.
+            if(event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)){
                 if(socket == &listener_socket_){
                     logger_.log("%:% %() % EPOLLIN listener_socket_: %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket->getFD());
                     have_new_connections_ = true;
@@ -52,40 +102,52 @@ namespace Common {
                 }
                 logger_.log("%:% %() % EPOLLIN socket: %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket->getFD());
 
-                if(std::find(receive_sockets_.begin(), receive_sockets_.end(), socket) == receive_sockets_.end()){
-                    receive_sockets_.push_back(socket);
-                }
+                addToSocketList(receive_sockets_, socket, InReceiveSockets);
             }
 
-            if(event.events & EPOLLOUT){
-                if(std::find(send_sockets_.begin(), send_sockets_.end(), socket) == send_sockets_.end())
-                    send_sockets_.push_back(socket);
-            }
+            if(event.events & EPOLLOUT)
+                addToSocketList(send_sockets_, socket, InSendSockets);
         }
 
         if(have_new_connections_){
             logger_.log("%:% %() % have_new_connection\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
 
-            sockaddr_storage addr;
-            socklen_t addr_len = sizeof(addr);
+            // The listener is edge triggered, accept everything that is pending.
+            while(true){
+                sockaddr_storage addr;
+                socklen_t addr_len = sizeof(addr);
+
+                const int fd = accept(listener_socket_.getFD(), reinterpret_cast<sockaddr*>(&addr), &addr_len);
+                if(fd < 0)
+                    break;
+
+                if(sockets_.size() == max_sockets_) [[unlikely]] {
+                    logger_.log("%:% %() % max sockets % reached, closing connection: %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), max_sockets_, fd);
+                    close(fd);
+                    continue;
+                }
 
-            int fd = accept(listener_socket_.getFD(), reinterpret_cast<sockaddr*>(&addr), &addr_len);
-            
-            if(fd >= 0) [[likely]] {
                 ASSERT(setNonBlocking(fd) && disableNagle(fd), "Failed to set non-blocking or disabling Nagle on socket: " + std::to_string(fd));
 
+                // Captured reads carry the kernel receive time.
+                if(capture_)
+                    ASSERT(enableSOTimestamp(fd), "Failed to enable SO_TIMESTAMP on socket: " + std::to_string(fd) + " errno: " + std::string(strerror(errno)));
+
                 logger_.log("%:% %() % accept new connection: %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), fd);
 
-                auto new_socket = new TCPSocket(logger_);
+                auto new_socket = new TCPSocket(logger_, socket_buffer_size_);
+                sockets_.push_back(new_socket);
                 new_socket->setFD(fd);
                 new_socket->setCallback(recv_callback_);
+                new_socket->setCapture(capture_);
 
                 ASSERT(addToEpollList(new_socket), "Unable to add socket. error: " + std::string(strerror(errno)));
 
-                if(std::find(receive_sockets_.begin(), receive_sockets_.end(), new_socket) == receive_sockets_.end()){
-                    receive_sockets_.push_back(new_socket);
-                }
+                addToSocketList(receive_sockets_, new_socket, InReceiveSockets);
             }
         }
+
+        if(timer_wheel_)
+            timer_wheel_->advance(getCurrentNanos());
     }
 }
\ No newline at end of file
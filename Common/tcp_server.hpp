@@ -3,9 +3,13 @@
 #include <sys/epoll.h>
 
 #include "tcp_socket.hpp"
+#include "timer_wheel.hpp"
+#include "flat_hash_map.hpp"
 
 
 namespace Common {
+    constexpr size_t TCPServerMaxSockets = 4096;
+
     class TCPServer {
         private:
             int epoll_fd_ = -1;
@@ -13,20 +17,65 @@ namespace Common {
             Logger& logger_;
             TCPSocket listener_socket_;
 
-            epoll_event events_[1024];
+            static constexpr int MaxEpollEvents = 1024;
+            epoll_event events_[MaxEpollEvents];
             std::vector<TCPSocket*> receive_sockets_, send_sockets_;
 
+            // Which of receive_sockets_ / send_sockets_ a socket is already in.
+            static constexpr uint8_t InReceiveSockets = 1;
+            static constexpr uint8_t InSendSockets = 2;
+            FlatHashMap<const TCPSocket*, uint8_t> socket_lists_;
+
+            // Every accepted socket that is still open, owned by the server.
+            std::vector<TCPSocket*> sockets_;
+            // Found closed by sendAndRecv(), removed once it is done with the lists.
+            std::vector<TCPSocket*> closed_sockets_;
+            const size_t socket_buffer_size_;
+            const size_t max_sockets_;
+
             std::string time_str_;
 
+            TCPCapture* capture_ = nullptr;
+
+            TimerWheel* timer_wheel_ = nullptr;
+            // Bounds how long poll() blocks with a timer wheel set, whatever the next deadline.
+            static constexpr Nanos MaxTimerPollWait = 100 * NANOS_TO_MILLIS;
+
             auto addToEpollList(TCPSocket* socket);
+
+            auto addToSocketList(std::vector<TCPSocket*>& list, TCPSocket* socket, uint8_t list_bit) noexcept -> void;
+
+            auto closeSocket(TCPSocket* socket) noexcept -> void;
         
         public:
             std::function<void(TCPSocket* s, Nanos rx_time)> recv_callback_ = nullptr;
             std::function<void()> recv_finished_callback_ = nullptr;
+            /// Called for a socket the peer has closed, just before the server closes and deletes it.
+            std::function<void(TCPSocket* s)> disconnect_callback_ = nullptr;
             
-            explicit TCPServer(Logger& logger) : logger_(logger), listener_socket_(logger) {}
+            /// Connections beyond max_sockets open at once are closed as soon as they are accepted.
+            explicit TCPServer(Logger& logger, size_t socket_buffer_size = TCPBufferSize, size_t max_sockets = TCPServerMaxSockets)
+                : logger_(logger), listener_socket_(logger, 0), socket_lists_(max_sockets), socket_buffer_size_(socket_buffer_size), max_sockets_(max_sockets) {}
+
+            ~TCPServer();
+
+            /// reuse_port lets several servers listen on the same port, see TCPReactorPool.
+            auto listen(const std::string& iface, int port, bool reuse_port = false) -> void;
+
+            auto getNumSockets() const noexcept {
+                return sockets_.size();
+            }
+
+            /// Capture reads on every socket accepted from now on, see TCPReplayer.
+            auto setCapture(TCPCapture* capture) noexcept -> void {
+                capture_ = capture;
+            }
 
-            auto listen(const std::string& iface, int port) -> void;
+            /// Fire timers from poll(). poll() then blocks in epoll_wait() until the next deadline instead of
+            /// returning immediately, so only use this when sends are driven by receives or timers.
+            auto setTimerWheel(TimerWheel* timer_wheel) noexcept -> void {
+                timer_wheel_ = timer_wheel;
+            }
 
             auto poll() noexcept -> void;
 
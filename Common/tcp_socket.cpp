@@ -1,9 +1,10 @@
 #include "tcp_socket.hpp"
+#include "warm_up.hpp"
 
 namespace Common {
     
-    auto TCPSocket::connect(const std::string& ip, const std::string& iface, int port, bool is_listening_) -> int {
-        const socketConfig sockCfg{ip, iface, port, false, is_listening_, false};
+    auto TCPSocket::connect(const std::string& ip, const std::string& iface, int port, bool is_listening_, bool reuse_port, bool needs_so_timestamp) -> int {
+        const socketConfig sockCfg{ip, iface, port, false, is_listening_, needs_so_timestamp, reuse_port};
 
         socket_fd_ = createSocket(logger_, sockCfg);
 
@@ -14,30 +15,75 @@ namespace Common {
         return socket_fd_;
     }
 
+    auto TCPSocket::flushOutbound() noexcept -> void {
+        const auto n = ::send(socket_fd_, outbound_data_.data(), next_valid_write_idx_, MSG_DONTWAIT | MSG_NOSIGNAL);
+        logger_.log("%:% %() % flush socket:% len:% sent:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket_fd_, next_valid_write_idx_, n);
+
+        if(n > 0){
+            memmove(outbound_data_.data(), outbound_data_.data() + n, next_valid_write_idx_ - n);
+            next_valid_write_idx_ -= n;
+        }
+    }
+
     auto TCPSocket::send(const void* data, size_t len) noexcept -> void {
+        // A burst larger than the buffer, make room by sending what is queued ahead of the next sendAndRecv().
+        if(next_valid_write_idx_ + len > outbound_data_.size()) [[unlikely]] {
+            flushOutbound();
+            if(next_valid_write_idx_ + len > outbound_data_.size())
+                FATAL("TCPSocket outbound buffer overflow socket:" + std::to_string(socket_fd_) + " queued:" + std::to_string(next_valid_write_idx_) +
+                      " len:" + std::to_string(len) + " size:" + std::to_string(outbound_data_.size()));
+        }
+
         memcpy(outbound_data_.data() + next_valid_write_idx_, data, len);
         next_valid_write_idx_ += len;
     }
 
+    auto TCPSocket::injectRecv(const void* data, size_t len, Nanos rx_time) noexcept -> void {
+        if(next_valid_read_idx_ + len > inbound_data_.size()) [[unlikely]]
+            FATAL("TCPSocket inbound buffer overflow on injectRecv() socket:" + std::to_string(socket_fd_) + " pending:" + std::to_string(next_valid_read_idx_) +
+                  " len:" + std::to_string(len) + " size:" + std::to_string(inbound_data_.size()));
+
+        memcpy(inbound_data_.data() + next_valid_read_idx_, data, len);
+        next_valid_read_idx_ += len;
+
+        recv_callback_(this, rx_time);
+    }
+
+    auto TCPSocket::declareHotMemory(WarmUp& warm_up, const std::string& name) noexcept -> void {
+        warm_up.declareHotMemory(name + " outbound", outbound_data_.data(), outbound_data_.size());
+        warm_up.declareHotMemory(name + " inbound", inbound_data_.data(), inbound_data_.size());
+    }
+
     auto TCPSocket::sendAndRecv() noexcept -> bool {
         char ctrl[CMSG_SPACE(sizeof(struct timeval))];
-        auto cmsg = reinterpret_cast<struct cmsghdr*>(&ctrl);
 
-        iovec iov{inbound_data_.data() + next_valid_read_idx_, TCPBufferSize - next_valid_read_idx_};
+        iovec iov{inbound_data_.data() + next_valid_read_idx_, inbound_data_.size() - next_valid_read_idx_};
         msghdr msg{&sock_attrib_, sizeof(sock_attrib_), &iov, 1, ctrl, sizeof(ctrl), 0};
 
         const auto read_size = recvmsg(socket_fd_, &msg, MSG_DONTWAIT);
+
+        // 0 is the peer's FIN, unless there was no room left to read into.
+        if((!read_size && iov.iov_len) || (read_size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) [[unlikely]]
+            closed_ = true;
+
         if(read_size > 0){
             Nanos kernel_time = 0;
             timeval time_kernel;
 
-            if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP && cmsg->cmsg_len == CMSG_LEN(sizeof(time_kernel))){
+            // Only there with SO_TIMESTAMP enabled, see enableSOTimestamp().
+            const auto cmsg = CMSG_FIRSTHDR(&msg);
+            if(cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP && cmsg->cmsg_len == CMSG_LEN(sizeof(time_kernel))){
                 memcpy(&time_kernel, CMSG_DATA(cmsg), sizeof(time_kernel));
                 kernel_time = time_kernel.tv_sec * NANOS_TO_SECS + time_kernel.tv_usec * NANOS_TO_MICROS;
             }
 
             const auto user_time = getCurrentNanos();
 
+            if(capture_) [[unlikely]]
+                capture_->capture(socket_fd_, inbound_data_.data() + next_valid_read_idx_, read_size, kernel_time, user_time);
+
+            next_valid_read_idx_ += read_size;
+
             logger_.log("%:% %() % read socket:% len:% utime:% ktime:% diff:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket_fd_, next_valid_read_idx_, user_time, kernel_time, (user_time - kernel_time));
 
             recv_callback_(this, kernel_time);
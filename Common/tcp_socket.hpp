@@ -3,9 +3,12 @@
 #include<functional>
 
 #include "socket_utils.hpp"
+#include "tcp_capture.hpp"
 #include "macros.hpp"
 
 namespace Common {
+    class WarmUp;
+
     constexpr int TCPBufferSize = 64 * 1024 * 1024;
 
     class TCPSocket {
@@ -17,9 +20,17 @@ namespace Common {
 
             CallbackType recv_callback_ = nullptr;
 
+            TCPCapture* capture_ = nullptr;
+
+            // Set by sendAndRecv() once the peer has closed the connection or it has failed.
+            bool closed_ = false;
+
             std::string time_str_;
 
             Logger& logger_;
+
+            /// Sends as much of the outbound buffer as the socket takes now and keeps the rest.
+            auto flushOutbound() noexcept -> void;
         
         public:
             std::vector<char> outbound_data_;
@@ -27,9 +38,14 @@ namespace Common {
             std::vector<char> inbound_data_;
             size_t next_valid_read_idx_ = 0;
             
-            explicit TCPSocket(Logger& logger) : logger_(logger) {
-                outbound_data_.resize(TCPBufferSize);
-                inbound_data_.resize(TCPBufferSize);
+            explicit TCPSocket(Logger& logger, size_t buffer_size = TCPBufferSize) : logger_(logger) {
+                outbound_data_.resize(buffer_size);
+                inbound_data_.resize(buffer_size);
+            }
+
+            ~TCPSocket() {
+                if(socket_fd_ >= 0)
+                    close(socket_fd_);
             }
 
             inline auto getFD() noexcept -> int {
@@ -44,12 +60,28 @@ namespace Common {
                 recv_callback_ = callback;
             }
 
-            auto connect(const std::string& ip, const std::string& iface, int port, bool is_listening_) -> int;
+            /// Record every read on this socket, nullptr disables capture.
+            inline auto setCapture(TCPCapture* capture) noexcept -> void {
+                capture_ = capture;
+            }
+
+            /// needs_so_timestamp has the kernel timestamp reads, recv_callback_ then gets the kernel receive time.
+            auto connect(const std::string& ip, const std::string& iface, int port, bool is_listening_, bool reuse_port = false, bool needs_so_timestamp = false) -> int;
 
             auto sendAndRecv() noexcept -> bool;
 
+            auto isClosed() const noexcept {
+                return closed_;
+            }
+
+            /// Queues data for the next sendAndRecv(). If it does not fit, flushes first, and FATALs if it still does not fit.
             auto send(const void* data, size_t len) noexcept -> void;
 
+            /// Deliver previously captured bytes through recv_callback_ as if they were read from the socket.
+            auto injectRecv(const void* data, size_t len, Nanos rx_time) noexcept -> void;
+
+            auto declareHotMemory(WarmUp& warm_up, const std::string& name) noexcept -> void;
+
             TCPSocket() = delete;
             TCPSocket(const TCPSocket&) = delete;
             TCPSocket(const TCPSocket&&) = delete;
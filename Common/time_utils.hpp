@@ -3,6 +3,7 @@
 #include <string>
 #include <chrono>
 #include <ctime>
+#include <x86intrin.h>
 
 namespace Common {
     typedef int64_t Nanos;
@@ -17,6 +18,11 @@ namespace Common {
         return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     }
 
+    /// Raw TSC ticks, for measuring very short intervals.
+    inline auto rdtsc() noexcept {
+        return __rdtsc();
+    }
+
     inline auto& getCurrentTimeStr(std::string* time_str) {
         const auto time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
         time_str->assign(ctime(&time));
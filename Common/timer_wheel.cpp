@@ -0,0 +1,176 @@
+#include "timer_wheel.hpp"
+
+namespace Common {
+    TimerWheel::TimerWheel(size_t max_timers, Nanos tick_nanos, const ExpireCallbackType& expire_callback, Nanos now)
+        : tick_nanos_(tick_nanos), origin_(now), node_pool_(max_timers), expire_callback_(expire_callback) {
+        // Mempool FATALs when its last free block is handed out, hence the extra node.
+        ASSERT(tick_nanos_ > 0, "TimerWheel tick should be positive: " + std::to_string(tick_nanos_));
+    }
+
+    auto TimerWheel::link(TimerNode* node, uint64_t min_tick) noexcept -> void {
+        if(node->expiry_tick_ < min_tick)
+            node->expiry_tick_ = min_tick;
+
+        auto delta = node->expiry_tick_ - current_tick_;
+        if(delta > TIMER_WHEEL_MAX_TICKS) [[unlikely]] {
+            node->expiry_tick_ = current_tick_ + TIMER_WHEEL_MAX_TICKS;
+            delta = TIMER_WHEEL_MAX_TICKS;
+        }
+
+        // Lowest level whose span covers the delta. A slot is processed at the start of its block, so a
+        // delta of a full level span lands in the current slot index one wrap from now, which is still on time.
+        size_t level = 0;
+        while(delta >> (TIMER_WHEEL_SLOT_BITS * (level + 1)))
+            level++;
+
+        const auto slot = (node->expiry_tick_ >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+        node->level_ = level;
+        node->slot_ = slot;
+
+        auto& head = slots_[level][slot];
+        node->prev_ = nullptr;
+        node->next_ = head;
+        if(head)
+            head->prev_ = node;
+        head = node;
+
+        occupied_[level][slot / 64] |= (1ull << (slot % 64));
+    }
+
+    auto TimerWheel::unlink(TimerNode* node) noexcept -> void {
+        if(node->next_)
+            node->next_->prev_ = node->prev_;
+
+        if(node->prev_){
+            node->prev_->next_ = node->next_;
+        } else {
+            auto& head = slots_[node->level_][node->slot_];
+            head = node->next_;
+            if(!head)
+                occupied_[node->level_][node->slot_ / 64] &= ~(1ull << (node->slot_ % 64));
+        }
+    }
+
+    auto TimerWheel::schedule(Nanos deadline, uint64_t user_data) noexcept -> TimerHandle {
+        // Round up so a timer never fires before its deadline.
+        const auto offset = std::max<Nanos>(deadline - origin_, 0);
+        const uint64_t expiry_tick = (offset + tick_nanos_ - 1) / tick_nanos_;
+
+        auto node = node_pool_.allocate();
+        node->expiry_tick_ = expiry_tick;
+        node->user_data_ = user_data;
+        node->generation_ = next_generation_++;
+
+        // The current tick has already been processed, the earliest a new timer can fire is the next one.
+        link(node, current_tick_ + 1);
+        num_timers_++;
+
+        return {node, node->generation_};
+    }
+
+    auto TimerWheel::cancel(TimerHandle handle) noexcept -> bool {
+        if(!handle.node_ || handle.node_->generation_ != handle.generation_)
+            return false;
+
+        unlink(handle.node_);
+        handle.node_->generation_ = 0;
+        node_pool_.deallocate(handle.node_);
+        num_timers_--;
+
+        return true;
+    }
+
+    auto TimerWheel::cascade(size_t level, size_t slot) noexcept -> void {
+        auto node = slots_[level][slot];
+        slots_[level][slot] = nullptr;
+        occupied_[level][slot / 64] &= ~(1ull << (slot % 64));
+
+        while(node){
+            auto next = node->next_;
+            // Timers due this very tick go to the level 0 slot about to be expired.
+            link(node, current_tick_);
+            node = next;
+        }
+    }
+
+    auto TimerWheel::expireSlot(size_t slot) noexcept -> size_t {
+        size_t num_expired = 0;
+
+        // Callbacks can only schedule into later slots, so this terminates.
+        for(auto node = slots_[0][slot]; node; node = slots_[0][slot]){
+            unlink(node);
+
+            const TimerHandle handle{node, node->generation_};
+            const auto user_data = node->user_data_;
+
+            node->generation_ = 0;
+            node_pool_.deallocate(node);
+            num_timers_--;
+            num_expired++;
+
+            expire_callback_(handle, user_data);
+        }
+
+        return num_expired;
+    }
+
+    auto TimerWheel::nextEventTick() const noexcept -> uint64_t {
+        const auto slot = current_tick_ & TIMER_WHEEL_SLOT_MASK;
+        const auto block_start = current_tick_ - slot;
+
+        for(auto word = (slot + 1) / 64; word < TIMER_WHEEL_SLOTS / 64; word++){
+            auto bits = occupied_[0][word];
+            if(word == (slot + 1) / 64)
+                bits &= ~0ull << ((slot + 1) % 64);
+
+            if(bits)
+                return block_start + word * 64 + __builtin_ctzll(bits);
+        }
+
+        return block_start + TIMER_WHEEL_SLOTS;
+    }
+
+    auto TimerWheel::advance(Nanos now) noexcept -> size_t {
+        if(now < origin_) [[unlikely]]
+            return 0;
+
+        const uint64_t target_tick = (now - origin_) / tick_nanos_;
+        size_t num_expired = 0;
+
+        while(current_tick_ < target_tick){
+            if(!num_timers_){
+                current_tick_ = target_tick;
+                break;
+            }
+
+            const auto next_tick = nextEventTick();
+            if(next_tick > target_tick){
+                current_tick_ = target_tick;
+                break;
+            }
+
+            current_tick_ = next_tick;
+
+            // Level 0 wrapped, pull the next block of every level that wrapped down a level.
+            if(!(current_tick_ & TIMER_WHEEL_SLOT_MASK)){
+                for(size_t level = 1; level < TIMER_WHEEL_LEVELS; level++){
+                    const auto slot = (current_tick_ >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+                    cascade(level, slot);
+                    if(slot)
+                        break;
+                }
+            }
+
+            num_expired += expireSlot(current_tick_ & TIMER_WHEEL_SLOT_MASK);
+        }
+
+        return num_expired;
+    }
+
+    auto TimerWheel::nextDeadline() const noexcept -> Nanos {
+        if(!num_timers_)
+            return TIMER_WHEEL_NO_DEADLINE;
+
+        return origin_ + static_cast<Nanos>(nextEventTick()) * tick_nanos_;
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <limits>
+
+#include "macros.hpp"
+#include "time_utils.hpp"
+#include "mem_pool.hpp"
+
+namespace Common {
+    constexpr size_t TIMER_WHEEL_LEVELS = 4;
+    constexpr size_t TIMER_WHEEL_SLOT_BITS = 8;
+    constexpr size_t TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_SLOT_BITS;
+    constexpr uint64_t TIMER_WHEEL_SLOT_MASK = TIMER_WHEEL_SLOTS - 1;
+
+    /// Furthest a timer can be scheduled ahead, in ticks. Later deadlines are clamped to it.
+    constexpr uint64_t TIMER_WHEEL_MAX_TICKS = (1ull << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+
+    constexpr Nanos TIMER_WHEEL_NO_DEADLINE = std::numeric_limits<Nanos>::max();
+
+    /// Intrusive list node of a scheduled timer, lives in the wheel's Mempool.
+    struct TimerNode {
+        TimerNode* prev_ = nullptr;
+        TimerNode* next_ = nullptr;
+
+        uint64_t expiry_tick_ = 0;
+        uint64_t user_data_ = 0;
+        uint64_t generation_ = 0;
+
+        uint8_t level_ = 0;
+        uint8_t slot_ = 0;
+    };
+
+    /// Returned by schedule(). The generation makes cancel() of an expired or cancelled timer a no-op
+    /// even after its node has been reused.
+    struct TimerHandle {
+        TimerNode* node_ = nullptr;
+        uint64_t generation_ = 0;
+    };
+
+    /// Hierarchical timing wheel: TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots, each level
+    /// TIMER_WHEEL_SLOTS times coarser than the one below. Timers cascade down a level every time the
+    /// level below wraps and fire from level 0.
+    /// schedule() and cancel() are O(1) and never allocate, advance() skips over empty slots.
+    /// Deadlines are rounded up to the tick, a timer never fires early. Single threaded.
+    class TimerWheel final {
+        public:
+            /// Called from advance() for every expired timer with the user_data it was scheduled with.
+            /// May schedule() and cancel() timers.
+            typedef std::function<void(TimerHandle handle, uint64_t user_data)> ExpireCallbackType;
+
+        private:
+            const Nanos tick_nanos_;
+            const Nanos origin_;
+            uint64_t current_tick_ = 0;
+
+            Mempool<TimerNode> node_pool_;
+            size_t num_timers_ = 0;
+            uint64_t next_generation_ = 1;
+
+            std::array<std::array<TimerNode*, TIMER_WHEEL_SLOTS>, TIMER_WHEEL_LEVELS> slots_{};
+            // Bit per non-empty slot, to find the next slot with work without walking the wheel.
+            std::array<std::array<uint64_t, TIMER_WHEEL_SLOTS / 64>, TIMER_WHEEL_LEVELS> occupied_{};
+
+            ExpireCallbackType expire_callback_;
+
+            auto link(TimerNode* node, uint64_t min_tick) noexcept -> void;
+            auto unlink(TimerNode* node) noexcept -> void;
+
+            auto cascade(size_t level, size_t slot) noexcept -> void;
+            auto expireSlot(size_t slot) noexcept -> size_t;
+
+            /// Next tick after current_tick_ at which advance() has work to do: a non-empty level 0 slot or a level 0 wrap.
+            auto nextEventTick() const noexcept -> uint64_t;
+
+        public:
+            /// max_timers live timers, all nodes are allocated here. now is the wheel's tick 0.
+            TimerWheel(size_t max_timers, Nanos tick_nanos, const ExpireCallbackType& expire_callback, Nanos now = getCurrentNanos());
+
+            /// Fires at the first advance() at or after deadline.
+            auto schedule(Nanos deadline, uint64_t user_data) noexcept -> TimerHandle;
+
+            auto scheduleAfter(Nanos now, Nanos delay, uint64_t user_data) noexcept {
+                return schedule(now + delay, user_data);
+            }
+
+            /// Returns false if the timer had already fired or been cancelled.
+            auto cancel(TimerHandle handle) noexcept -> bool;
+
+            /// Fires every timer due at or before now, returns the number fired.
+            auto advance(Nanos now) noexcept -> size_t;
+
+            /// Earliest time advance() might fire a timer, TIMER_WHEEL_NO_DEADLINE if none are scheduled.
+            /// Exact for timers within TIMER_WHEEL_SLOTS ticks, otherwise the next cascade, which is never later than the timer.
+            auto nextDeadline() const noexcept -> Nanos;
+
+            auto size() const noexcept {
+                return num_timers_;
+            }
+
+            auto getTickNanos() const noexcept {
+                return tick_nanos_;
+            }
+
+            TimerWheel() = delete;
+            TimerWheel(const TimerWheel&) = delete;
+            TimerWheel(const TimerWheel&&) = delete;
+            TimerWheel& operator=(const TimerWheel&) = delete;
+            TimerWheel& operator=(const TimerWheel&&) = delete;
+    };
+}
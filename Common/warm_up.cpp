@@ -0,0 +1,66 @@
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "warm_up.hpp"
+
+namespace Common {
+    auto WarmUp::declareHotMemory(const std::string& name, void* data, size_t size, bool concurrent) noexcept -> void {
+        ASSERT(data || !size, "WarmUp region " + name + " has no memory.");
+        regions_.push_back({name, data, size, concurrent});
+    }
+
+    auto WarmUp::addStage(const std::string& name, const StageFuncType& drive, const StageFuncType& discard) noexcept -> void {
+        ASSERT(drive != nullptr, "WarmUp stage " + name + " has nothing to drive.");
+        stages_.push_back({name, drive, discard});
+    }
+
+    auto WarmUp::lockMemory(bool lock_future) noexcept -> bool {
+        if(mlockall(lock_future ? (MCL_CURRENT | MCL_FUTURE) : MCL_CURRENT) != 0){
+            std::cerr << "WarmUp mlockall() failed, memory stays unlocked: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        memory_locked_ = true;
+        return true;
+    }
+
+    auto WarmUp::prefault() noexcept -> size_t {
+        const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+        size_t pages = 0;
+        for(const auto& region : regions_){
+            if(!region.size_ || region.concurrent_)
+                continue;
+
+            // Volatile so that the write back is not optimised away, it is what makes the kernel back the page.
+            auto data = static_cast<volatile char*>(region.data_);
+            const auto first_page = reinterpret_cast<uintptr_t>(region.data_) / page_size;
+            const auto last_page = (reinterpret_cast<uintptr_t>(region.data_) + region.size_ - 1) / page_size;
+
+            for(size_t offset = 0; offset < region.size_; offset += page_size - (reinterpret_cast<uintptr_t>(data + offset) % page_size))
+                data[offset] = data[offset];
+            pages += last_page - first_page + 1;
+        }
+
+        prefaulted_pages_ += pages;
+        return pages;
+    }
+
+    auto WarmUp::runStages(size_t iterations) noexcept -> void {
+        for(auto& stage : stages_){
+            for(size_t i = 0; i < iterations; i++)
+                stage.drive_();
+            if(stage.discard_)
+                stage.discard_();
+        }
+    }
+
+    auto WarmUp::run(size_t iterations, bool lock_memory, bool lock_future) noexcept -> void {
+        if(lock_memory)
+            lockMemory(lock_future);
+        prefault();
+        runStages(iterations);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "macros.hpp"
+
+namespace Common {
+    /// Memory a component touches on its hot path.
+    struct HotMemoryRegion {
+        std::string name_;
+        void* data_ = nullptr;
+        size_t size_ = 0;
+        // Written by a thread that already runs, prefault() leaves it alone.
+        bool concurrent_ = false;
+    };
+
+    /// Startup warm-up of the hot path, run once before going live and before the pipeline threads start.
+    /// Components declare their hot memory (see their declareHotMemory()), the application adds synthetic traffic
+    /// stages, then run() locks the memory mapped so far, pre-faults every declared page and drives each stage's dummy
+    /// messages through the pipeline, followed by the stage's discard that undoes their side effects.
+    /// Declared regions must be writable and stay valid until run() returns. A region some running thread writes meanwhile,
+    /// such as a Logger queue whose logger thread starts in the constructor, has to be declared concurrent.
+    class WarmUp final {
+        public:
+            typedef std::function<void()> StageFuncType;
+
+        private:
+            struct Stage {
+                std::string name_;
+                StageFuncType drive_;
+                StageFuncType discard_;
+            };
+
+            std::vector<HotMemoryRegion> regions_;
+            std::vector<Stage> stages_;
+
+            bool memory_locked_ = false;
+            size_t prefaulted_pages_ = 0;
+
+        public:
+            WarmUp() = default;
+
+            /// concurrent: another thread writes the region while run() runs. prefault() skips it, writing a byte back
+            /// could undo that thread's write in between. It is still locked, and is faulted in by whoever wrote it.
+            auto declareHotMemory(const std::string& name, void* data, size_t size, bool concurrent = false) noexcept -> void;
+
+            /// drive sends one dummy message through the pipeline, discard runs once after the last one.
+            auto addStage(const std::string& name, const StageFuncType& drive, const StageFuncType& discard) noexcept -> void;
+
+            /// mlockall() of the current mappings, and with lock_future of every later one too, which then makes each
+            /// later allocation fault in and count against RLIMIT_MEMLOCK. Needs CAP_IPC_LOCK or a large enough
+            /// RLIMIT_MEMLOCK, returns false and leaves memory unlocked otherwise.
+            auto lockMemory(bool lock_future = false) noexcept -> bool;
+
+            /// Writes one byte of every page of the declared regions that are not concurrent back in place, returns the number of pages.
+            auto prefault() noexcept -> size_t;
+
+            /// Calls each stage's drive iterations times and then its discard.
+            auto runStages(size_t iterations) noexcept -> void;
+
+            /// lockMemory(lock_future) when lock_memory, then prefault() and runStages(). Locking covers what is mapped
+            /// at the time, so call run() once the components that declared their memory are fully built.
+            auto run(size_t iterations, bool lock_memory = true, bool lock_future = false) noexcept -> void;
+
+            auto getRegions() const noexcept -> const std::vector<HotMemoryRegion>& {
+                return regions_;
+            }
+
+            auto getHotBytes() const noexcept {
+                size_t bytes = 0;
+                for(const auto& region : regions_)
+                    bytes += region.size_;
+                return bytes;
+            }
+
+            auto isMemoryLocked() const noexcept {
+                return memory_locked_;
+            }
+
+            auto getPrefaultedPages() const noexcept {
+                return prefaulted_pages_;
+            }
+
+            WarmUp(const WarmUp&) = delete;
+            WarmUp(const WarmUp&&) = delete;
+            WarmUp& operator=(const WarmUp&) = delete;
+            WarmUp& operator=(const WarmUp&&) = delete;
+    };
+}